@@ -0,0 +1,138 @@
+#!/usr/bin/python
+#
+# this converts the glcd fonts in src/fonts/ into the compiled
+# font format used by screen.c (font_t, see src/font.h):
+#
+# - direct glyph offset and width tables, no summing of widths
+# - lcd page native bit order (bit 0 = top pixel of the page) for
+#   all pages, the thiele residual bit shift is done here
+# - optional subset, only the given chars are kept
+#
+# usage: compile_font.py font.h[:chars] [font.h[:chars] ...] > font_compiled.h
+#
+import re
+import sys
+import textwrap
+
+FONT_FLAG_FIXED = 0x01
+FONT_FLAG_NOPAD = 0x02
+FONT_FLAG_SUBSET = 0x04
+FONT_GLYPH_NONE = 0xFF
+
+
+def parse_font(filename):
+    src = open(filename).read()
+    # strip comments, whichever starts first wins
+    src = re.sub(r"//[^\n]*|/\*.*?\*/", "", src, flags=re.S)
+
+    m = re.search(r"const\s+uint8_t\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;", src, re.S)
+    if not m:
+        sys.exit("%s: no font array found" % (filename))
+    name = m.group(1)
+
+    values = []
+    for item in m.group(2).split(","):
+        item = item.strip()
+        if not item:
+            continue
+        # char literals like '*'
+        item = re.sub(r"'(.)'", lambda c: str(ord(c.group(1))), item)
+        values.append(eval(item) & 0xFF)
+
+    return name, values
+
+
+def compile_font(filename, subset):
+    name, raw = parse_font(filename)
+
+    fixed = (raw[0] == 0) and (raw[1] < 2)
+    nopad = (raw[0] == 0) and (raw[1] == 1)
+    width = raw[2]
+    height = raw[3]
+    first = raw[4]
+    count = raw[5]
+    pages = (height + 7) // 8
+
+    # fetch glyph data in the original layout
+    glyphs = []
+    if fixed:
+        index = 6
+        for c in range(count):
+            glyphs.append((width, raw[index:index + pages * width]))
+            index += pages * width
+    else:
+        widths = raw[6:6 + count]
+        index = 6 + count
+        for c in range(count):
+            data = list(raw[index:index + pages * widths[c]])
+            index += pages * widths[c]
+            # thiele fonts store the residual bits of the last page
+            # shifted the wrong way, fix this once here
+            if height & 7:
+                last = (pages - 1) * widths[c]
+                for i in range(last, len(data)):
+                    data[i] >>= 8 - (height & 7)
+            glyphs.append((widths[c], data))
+
+    # the chars to keep
+    chars = list(range(first, first + count))
+    if subset is not None:
+        chars = sorted(set(ord(c) for c in subset if first <= ord(c) < first + count))
+        if not chars:
+            sys.exit("%s: empty subset" % (filename))
+
+    out_first = chars[0]
+    out_count = chars[-1] - chars[0] + 1
+
+    glyph_map = [FONT_GLYPH_NONE] * out_count
+    out_width = []
+    out_offset = []
+    out_data = []
+    for c in chars:
+        w, data = glyphs[c - first]
+        glyph_map[c - out_first] = len(out_width)
+        out_width.append(w)
+        out_offset.append(len(out_data))
+        out_data.extend(data)
+
+    flags = 0
+    if fixed:
+        flags |= FONT_FLAG_FIXED
+    if nopad:
+        flags |= FONT_FLAG_NOPAD
+    if subset is not None:
+        flags |= FONT_FLAG_SUBSET
+
+    def table(ctype, suffix, values, fmt):
+        print("static const %s %s_%s[] = {" % (ctype, name, suffix))
+        for line in textwrap.wrap(", ".join(fmt % v for v in values)):
+            print("    %s" % (line))
+        print("};")
+
+    print("// %s, %d chars, %d bytes glyph data" % (filename, len(chars), len(out_data)))
+    table("uint8_t", "glyph", glyph_map, "%d")
+    table("uint8_t", "width", out_width, "%d")
+    table("uint16_t", "offset", out_offset, "%d")
+    table("uint8_t", "data", out_data, "0x%02X")
+    print("const font_t %s = {" % (name))
+    print("    %d, %d, %d, 0x%02X, %d, %d," % (height, pages, width, flags, out_first, out_count))
+    print("    %s_glyph, %s_width, %s_offset, %s_data" % (name, name, name, name))
+    print("};")
+    print("")
+
+
+print("/*")
+print("    generated by scripts/compile_font.py, do not edit")
+print("*/")
+print("#ifndef FONT_COMPILED_H_")
+print("#define FONT_COMPILED_H_")
+print("")
+print("#include \"font.h\"")
+print("")
+for arg in sys.argv[1:]:
+    if ":" in arg:
+        filename, subset = arg.split(":", 1)
+    else:
+        filename, subset = arg, None
+    compile_font(filename, subset)
+print("#endif  // FONT_COMPILED_H_")
@@ -25,73 +25,134 @@
 #include "wdt.h"
 #include "delay.h"
 #include "storage.h"
+#include <string.h>
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/adc.h>
 #include <libopencm3/stm32/dma.h>
-
+#include <libopencm3/stm32/timer.h>
+#include <libopencm3/cm3/nvic.h>
+#include "clocksource.h"
+#include "rftiming.h"
+#include "lswitch.h"
+#include "seqlock.h"
+
+// dma target: two halves of ADC_OVERSAMPLE sequences each. the dma fills
+// one half while the isr decimates the other one
+static uint16_t adc_dma_buffer[2][ADC_OVERSAMPLE][ADC_CHANNEL_COUNT];
+// decimated and filtered result of the last completed half
 static uint16_t adc_data[ADC_CHANNEL_COUNT];
-static uint16_t adc_battery_voltage_raw_filtered;
+// filter state: the last two decimated values (median of 3) and the
+// iir output in fixed point (value << ADC_FILTER_FP_SHIFT)
+static uint16_t adc_filter_history[ADC_CHANNEL_COUNT][2];
+static int32_t adc_filter_state[ADC_CHANNEL_COUNT];
+// battery voltage low pass, fixed point (raw << ADC_BATTERY_FILTER_SHIFT)
+static uint32_t adc_battery_voltage_filtered;
+
+// hw revision mapping, resolved once: adc_data index for every channel id
+static uint8_t adc_channel_map[CHANNEL_ID_SIZE];
+static uint8_t adc_channel_inverted[CHANNEL_ID_SIZE];
+
+// stick calibration as multiply-shift coefficients, see adc_calibration_update()
+typedef struct {
+    int16_t center;
+    int32_t scale_neg;
+    int32_t scale_pos;
+} adc_stick_coef_t;
+static adc_stick_coef_t adc_stick_coef[4];
+
+static volatile adc_snapshot_t adc_snapshot;
+// frame synchronous mode, executed after every snapshot
+static volatile adc_callback_t adc_snapshot_callback;
 
 // internal functions
 static void adc_init_rcc(void);
 static void adc_init_gpio(void);
 static void adc_init_mode(void);
 static void adc_init_dma(void);
+static void adc_init_timer(void);
+static void adc_init_channel_map(void);
 static void adc_dma_arm(void);
+static int32_t adc_rescale(uint8_t idx, uint16_t raw);
+static void adc_filter_battery_voltage(void);
+static void adc_decimate(uint16_t (*samples)[ADC_CHANNEL_COUNT]);
+static uint16_t adc_median3(uint16_t a, uint16_t b, uint16_t c);
+static void adc_update_snapshot(void);
+static void adc_dma_realign(void);
 
 void adc_init(void) {
     debug("adc: init\n"); debug_flush();
 
-    adc_battery_voltage_raw_filtered = 0;
+    adc_battery_voltage_filtered = 0;
+    seqlock_init(&adc_snapshot.sequence);
+    adc_snapshot_callback = 0;
+
+    // init values(for debugging)
+    uint32_t i;
+    for (i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        adc_data[i] = i;
+        // the first decimated value will initialise the filter
+        adc_filter_state[i] = -1;
+    }
+
+    adc_init_channel_map();
+    // storage is not loaded yet, storage_load() will update this again
+    adc_calibration_update();
 
     adc_init_rcc();
     adc_init_gpio();
     adc_init_mode();
     adc_init_dma();
+    adc_init_timer();
+}
 
-    // init values(for debugging)
+static void adc_init_channel_map(void) {
     uint32_t i;
-    for (i = 0; i < ADC_CHANNEL_COUNT; i++) {
-        adc_data[i] = i;
+
+    for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+        adc_channel_map[i] = i;
+        adc_channel_inverted[i] = 0;
     }
-}
 
-uint16_t adc_get_channel(uint32_t id) {
     // fetch correct adc channel based on hw revision
     if (config_hw_revision == CONFIG_HW_REVISION_I6S) {
         // FS-i6S mapping:
-        switch (id) {
-            default : return adc_data[id];
-            case (CHANNEL_ID_AILERON)  : return adc_data[0];
-            case (CHANNEL_ID_ELEVATION): return adc_data[1];
-            case (CHANNEL_ID_THROTTLE) : return adc_data[2];
-            case (CHANNEL_ID_RUDDER)   : return adc_data[3];
-            case (CHANNEL_ID_CH0)      : return adc_data[4];
-            case (CHANNEL_ID_CH1)      : return adc_data[5];
-            case (CHANNEL_ID_CH2)      : return adc_data[8];
-            case (CHANNEL_ID_CH3)      : return adc_data[9];
-        }
+        adc_channel_map[CHANNEL_ID_AILERON]   = 0;
+        adc_channel_map[CHANNEL_ID_ELEVATION] = 1;
+        adc_channel_map[CHANNEL_ID_THROTTLE]  = 2;
+        adc_channel_map[CHANNEL_ID_RUDDER]    = 3;
+        adc_channel_map[CHANNEL_ID_CH0]       = 4;
+        adc_channel_map[CHANNEL_ID_CH1]       = 5;
+        adc_channel_map[CHANNEL_ID_CH2]       = 8;
+        adc_channel_map[CHANNEL_ID_CH3]       = 9;
     } else if (config_hw_revision == CONFIG_HW_REVISION_EVOLUTION) {
         // TGY Evolution mapping:
-        switch (id) {
-            default : return adc_data[id];
-            case (CHANNEL_ID_AILERON)  : return 4095 - adc_data[3];
-            case (CHANNEL_ID_ELEVATION): return 4095 - adc_data[2];
-            case (CHANNEL_ID_THROTTLE) : return 4095 - adc_data[1];
-            case (CHANNEL_ID_RUDDER)   : return 4095 - adc_data[0];
-            case (CHANNEL_ID_CH0)      : return adc_data[5];
-            case (CHANNEL_ID_CH1)      : return adc_data[8];
-            case (CHANNEL_ID_CH2)      : return adc_data[6];
-            case (CHANNEL_ID_CH3)      : return adc_data[4];
+        adc_channel_map[CHANNEL_ID_AILERON]   = 3;
+        adc_channel_map[CHANNEL_ID_ELEVATION] = 2;
+        adc_channel_map[CHANNEL_ID_THROTTLE]  = 1;
+        adc_channel_map[CHANNEL_ID_RUDDER]    = 0;
+        adc_channel_map[CHANNEL_ID_CH0]       = 5;
+        adc_channel_map[CHANNEL_ID_CH1]       = 8;
+        adc_channel_map[CHANNEL_ID_CH2]       = 6;
+        adc_channel_map[CHANNEL_ID_CH3]       = 4;
+        for (i = CHANNEL_ID_AILERON; i <= CHANNEL_ID_RUDDER; i++) {
+            adc_channel_inverted[i] = 1;
         }
+    } else {
+        // else: undefined!
+        debug("adc: invalid hw revision ");
+        debug_put_uint8(config_hw_revision);
+        debug(" given!\n"); debug_flush();
     }
+}
 
-    // else: undefined!
-    debug("adc: invalid hw revision ");
-    debug_put_uint8(config_hw_revision);
-    debug(" given!\n"); debug_flush();
-    return 0;
+// raw channel value (0..4095) of the last completed adc cycle
+uint16_t adc_get_channel(uint32_t id) {
+    if (id >= CHANNEL_ID_SIZE) {
+        // not a mapped channel, return the raw adc data
+        return adc_data[id];
+    }
+    return adc_snapshot.raw[id];
 }
 
 char *adc_get_channel_name(uint8_t i, bool short_descr) {
@@ -109,64 +170,210 @@ char *adc_get_channel_name(uint8_t i, bool short_descr) {
 }
 
 
-#define ADC_RESCALE_TARGET_RANGE 3200
-// return the adc channel rescaled from 0...4095 to -TARGET_RANGE...+TARGET_RANGE
-// switches are scaled manually, sticks use calibration data
-int32_t adc_get_channel_rescaled(uint8_t idx) {
+// precompile the stick calibration and the model stick scale into
+// coefficients for adc_rescale(). the cortex-m0 has no hw divider, thus
+// all divisions are done here and not once per channel and adc cycle.
+// call this whenever storage.stick_calibration or the stick scale changes
+void adc_calibration_update(void) {
+    uint32_t i;
     int32_t divider;
+    int32_t scale;
+
+    for (i = 0; i < 4; i++) {
+        // apply the scale factor for ail and ele
+        scale = ADC_RESCALE_TARGET_RANGE;
+        if ((i == CHANNEL_ID_AILERON) || (i == CHANNEL_ID_ELEVATION)) {
+            scale = (scale * storage.model[storage.current_model].stick_scale) / 100;
+        }
+
+        // below center
+        divider = storage.stick_calibration[i][1] - storage.stick_calibration[i][0];
+        divider = max(ADC_RESCALE_DIVIDER_MIN, divider);
+        adc_stick_coef[i].scale_neg = (scale << ADC_RESCALE_COEF_SHIFT) / divider;
+
+        // above center
+        divider = storage.stick_calibration[i][2] - storage.stick_calibration[i][1];
+        divider = max(ADC_RESCALE_DIVIDER_MIN, divider);
+        adc_stick_coef[i].scale_pos = (scale << ADC_RESCALE_COEF_SHIFT) / divider;
+
+        adc_stick_coef[i].center = storage.stick_calibration[i][1];
+    }
+}
 
-    // fetch raw stick value (0..4095)
-    int32_t value = adc_get_channel(idx);
+// rescale the adc channel from 0...4095 to -TARGET_RANGE...+TARGET_RANGE
+// switches are scaled manually, sticks use calibration data
+static int32_t adc_rescale(uint8_t idx, uint16_t raw) {
+    int32_t value = raw;
 
     // sticks are ch0..3 and use calibration coefficents:
     if (idx < 4) {
         // apply center calibration value:
-        value = value - (int16_t)storage.stick_calibration[idx][1];
+        value = value - adc_stick_coef[idx].center;
 
         // now rescale this to +/- TARGET_RANGE
-        // fetch divider
         if (value < 0) {
-            divider = storage.stick_calibration[idx][1] - storage.stick_calibration[idx][0];
+            value = (value * adc_stick_coef[idx].scale_neg) >> ADC_RESCALE_COEF_SHIFT;
         } else {
-            divider = storage.stick_calibration[idx][2] - storage.stick_calibration[idx][1];
+            value = (value * adc_stick_coef[idx].scale_pos) >> ADC_RESCALE_COEF_SHIFT;
         }
-        // apply the scale
-        value = (value * ADC_RESCALE_TARGET_RANGE) / divider;
     } else {
         // for sticks we do not care about scaling/calibration (for now)
         // min is 0, max from adc is 4095 -> rescale this to +/- 3200
-        // rescale to 0...6400
-        value = (ADC_RESCALE_TARGET_RANGE * 2 * value) / 4096;
+        // rescale to 0...6400 (6400 / 4096 = 25 / 16)
+        value = (25 * value) >> 4;
         value = value - ADC_RESCALE_TARGET_RANGE;
     }
 
-    // apply the scale factor:
-    switch (idx) {
-        default:
-            // do not apply scale
-            break;
-        case (CHANNEL_ID_AILERON):
-        case (CHANNEL_ID_ELEVATION):
-            value = (value * storage.model[storage.current_model].stick_scale) / 100;
-            break;
-    }
-
     // limit value to -3200 ... 3200
     value = max(-ADC_RESCALE_TARGET_RANGE, min(ADC_RESCALE_TARGET_RANGE, value));
 
     return value;
 }
 
+int32_t adc_get_channel_rescaled(uint8_t idx) {
+    return adc_snapshot.rescaled[idx];
+}
+
 uint16_t adc_get_channel_packetdata(uint8_t idx) {
-    // frsky packets send us * 1.5
-    // where 1000 us =   0%
-    //       2000 us = 100%
-    // -> remap +/-3200 to 1500..3000
-    // 6400 => 1500 <=> 64 = 15
-    int32_t val = adc_get_channel_rescaled(idx);
-    val = (15 * val) / 64;
-    val = val + 2250;
-    return (uint16_t) val;
+    return adc_snapshot.packetdata[idx];
+}
+
+// copy a consistent snapshot. do not call this from an isr with a
+// higher priority than NVIC_PRIO_ADC, it would spin forever
+void adc_get_snapshot(adc_snapshot_t *snapshot) {
+    uint32_t sequence;
+
+    do {
+        sequence = seqlock_read_begin(&adc_snapshot.sequence);
+        memcpy(snapshot, (const void *)&adc_snapshot, sizeof(adc_snapshot_t));
+    } while (seqlock_read_retry(&adc_snapshot.sequence, sequence));
+}
+
+uint32_t adc_get_snapshot_sequence(void) {
+    return adc_snapshot.sequence;
+}
+
+// one half of the dma buffer was filled: decimate it and run the channel
+// pipeline once. HT = first half done, TC = second half done
+void DMA1_CHANNEL1_IRQHandler(void) {
+    if (dma_get_interrupt_flag(DMA1, ADC_DMA_CHANNEL, DMA_HTIF)) {
+        dma_clear_interrupt_flags(DMA1, ADC_DMA_CHANNEL, DMA_HTIF);
+        adc_decimate(adc_dma_buffer[0]);
+        adc_update_snapshot();
+    }
+
+    if (dma_get_interrupt_flag(DMA1, ADC_DMA_CHANNEL, DMA_TCIF)) {
+        dma_clear_interrupt_flags(DMA1, ADC_DMA_CHANNEL, DMA_TCIF);
+        adc_decimate(adc_dma_buffer[1]);
+        adc_update_snapshot();
+    }
+}
+
+static uint16_t adc_median3(uint16_t a, uint16_t b, uint16_t c) {
+    if (a > b) {
+        uint16_t t = a;
+        a = b;
+        b = t;
+    }
+    // now a <= b
+    if (c <= a) {
+        return a;
+    }
+    if (c >= b) {
+        return b;
+    }
+    return c;
+}
+
+// average ADC_OVERSAMPLE sequences, reject single spikes with a median
+// of the last three decimated values and smooth with a first order iir
+static void adc_decimate(uint16_t (*samples)[ADC_CHANNEL_COUNT]) {
+    uint32_t ch, n;
+    uint32_t sum;
+    uint16_t value;
+    uint8_t shift;
+
+    for (ch = 0; ch < ADC_CHANNEL_COUNT; ch++) {
+        sum = 0;
+        for (n = 0; n < ADC_OVERSAMPLE; n++) {
+            sum += samples[n][ch];
+        }
+        value = sum >> ADC_OVERSAMPLE_SHIFT;
+
+        if (adc_filter_state[ch] < 0) {
+            // first run, start with a settled filter
+            adc_filter_history[ch][0] = value;
+            adc_filter_history[ch][1] = value;
+            adc_filter_state[ch] = value << ADC_FILTER_FP_SHIFT;
+        }
+
+        // median of three
+        uint16_t median = adc_median3(value, adc_filter_history[ch][0], adc_filter_history[ch][1]);
+        adc_filter_history[ch][1] = adc_filter_history[ch][0];
+        adc_filter_history[ch][0] = value;
+
+        // iir, the internal temperature sensor is very noisy and slow
+        if (ch == ADC_CHANNEL_TEMPERATURE_INDEX) {
+            shift = ADC_FILTER_IIR_SHIFT_TEMPERATURE;
+        } else {
+            shift = ADC_FILTER_IIR_SHIFT;
+        }
+        adc_filter_state[ch] += (((int32_t)median << ADC_FILTER_FP_SHIFT) - adc_filter_state[ch]) >> shift;
+
+        // round to the nearest value
+        adc_data[ch] = (adc_filter_state[ch] + (1 << (ADC_FILTER_FP_SHIFT - 1))) >> ADC_FILTER_FP_SHIFT;
+    }
+}
+
+static void adc_update_snapshot(void) {
+    uint32_t i;
+    uint16_t raw;
+    int32_t value;
+
+    // odd sequence marks the snapshot as being updated
+    seqlock_write_begin(&adc_snapshot.sequence);
+
+    for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+        raw = adc_data[adc_channel_map[i]];
+        if (adc_channel_inverted[i]) {
+            raw = 4095 - raw;
+        }
+        adc_snapshot.raw[i] = raw;
+
+        value = adc_rescale(i, raw);
+        adc_snapshot.rescaled[i] = value;
+
+        // frsky packets send us * 1.5
+        // where 1000 us =   0%
+        //       2000 us = 100%
+        // -> remap +/-3200 to 1500..3000
+        // 6400 => 1500 <=> 64 = 15
+        adc_snapshot.packetdata[i] = ((15 * value) / 64) + 2250;
+    }
+
+    // evaluate the logical switches on the new values
+    adc_snapshot.switches = lswitch_process((const int16_t *)adc_snapshot.rescaled);
+
+    adc_snapshot.timestamp = rftiming_now();
+    seqlock_write_end(&adc_snapshot.sequence);
+
+    adc_filter_battery_voltage();
+
+    if (adc_snapshot_callback) {
+        adc_snapshot_callback();
+    }
+}
+
+static void adc_filter_battery_voltage(void) {
+    int32_t raw = adc_data[ADC_CHANNEL_BATTERY_INDEX] << ADC_BATTERY_FILTER_SHIFT;
+
+    if (adc_battery_voltage_filtered == 0) {
+        // initialise with current value
+        adc_battery_voltage_filtered = raw;
+    } else {
+        // low pass filter battery voltage
+        adc_battery_voltage_filtered += (raw - (int32_t)adc_battery_voltage_filtered) >> ADC_BATTERY_FILTER_SHIFT;
+    }
 }
 
 
@@ -212,7 +419,7 @@ uint32_t adc_get_battery_voltage(void) {
     // 1230 = 12.3 V
     // raw data is 0 .. 4095 ~ 0 .. 3300mV
     // Vadc = raw * 3300 / 4095
-    uint32_t raw = adc_battery_voltage_raw_filtered;
+    uint32_t raw = adc_battery_voltage_filtered >> ADC_BATTERY_FILTER_SHIFT;
     // the voltage divider is 5.1k / 10k
     // Vadc = Vbat * R2 / (R1+R2) = Vbat * 51/ 151
     // -> Vbat = Vadc * (R1-R2) / R2
@@ -222,26 +429,40 @@ uint32_t adc_get_battery_voltage(void) {
     return mv / 10;
 }
 
+// returns the chip temperature in deg C
+int16_t adc_get_temperature(void) {
+    int32_t raw = adc_data[ADC_CHANNEL_TEMPERATURE_INDEX];
+    int32_t cal1 = ADC_TS_CAL1;
+    int32_t cal2 = ADC_TS_CAL2;
+
+    if (cal2 == cal1) {
+        // no calibration data?!
+        return 0;
+    }
+
+    return 30 + ((raw - cal1) * (110 - 30)) / (cal2 - cal1);
+}
+
 static void adc_init_mode(void) {
     debug("adc: init mode\n"); debug_flush();
 
-    // set mode to continous
-    adc_set_continuous_conversion_mode(ADC1);
+    // one sequence per trigger
+    adc_set_single_conversion_mode(ADC1);
 
-    // no ext trigger
-    adc_disable_external_trigger_regular(ADC1);
+    // every TRGO of the sample timer starts a sequence (TRG4 = TIM15_TRGO)
+    adc_enable_external_trigger_regular(ADC1, ADC_CFGR1_EXTSEL_VAL(4), ADC_CFGR1_EXTEN_RISING_EDGE);
     // right 12-bit data alignment in ADC reg
     adc_set_right_aligned(ADC1);
     adc_set_resolution(ADC1, ADC_RESOLUTION_12BIT);
 
-    // adc_enable_temperature_sensor();
+    adc_enable_temperature_sensor();
     adc_disable_analog_watchdog(ADC1);
 
-    // configure channels 0...10
-    uint8_t channels[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    // configure channels 0...10 and the temperature sensor (16)
+    uint8_t channels[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 16};
 
-    // sample times for all channels
-    adc_set_sample_time_on_all_channels(ADC1, ADC_SMPTIME_041DOT5);
+    // sample times for all channels, the temperature sensor needs > 4us
+    adc_set_sample_time_on_all_channels(ADC1, ADC_SMPTIME_055DOT5);
 
     adc_set_regular_sequence(ADC1, sizeof(channels), channels);
 
@@ -255,7 +476,9 @@ static void adc_init_mode(void) {
 
 
 
-    // enable DMA for ADC
+    // enable DMA for ADC, keep generating dma requests after the
+    // transfer count wrapped (dma circular mode)
+    ADC_CFGR1(ADC1) |= ADC_CFGR1_DMACFG;
     adc_enable_dma(ADC1);
 }
 
@@ -266,7 +489,7 @@ static void adc_init_dma(void) {
     // clean init
     dma_channel_reset(DMA1, ADC_DMA_CHANNEL);
 
-    // DO NOT use circular mode, we will retrigger dma on our own!
+    // circular mode, the sample timer retriggers the conversions
     dma_enable_circular_mode(DMA1, ADC_DMA_CHANNEL);
 
 
@@ -288,44 +511,96 @@ static void adc_init_dma(void) {
 
     // source and destination start addresses
     dma_set_peripheral_address(DMA1, ADC_DMA_CHANNEL, (uint32_t)&ADC1_DR);
-    dma_set_memory_address(DMA1, ADC_DMA_CHANNEL, (uint32_t)adc_data);
+    dma_set_memory_address(DMA1, ADC_DMA_CHANNEL, (uint32_t)adc_dma_buffer);
 
-    // chunk of data to be transfered
-    dma_set_number_of_data(DMA1, ADC_DMA_CHANNEL, ADC_CHANNEL_COUNT);
+    // chunk of data to be transfered: both halves
+    dma_set_number_of_data(DMA1, ADC_DMA_CHANNEL, 2 * ADC_OVERSAMPLE * ADC_CHANNEL_COUNT);
+
+    // the channel pipeline runs once per completed half
+    dma_enable_half_transfer_interrupt(DMA1, ADC_DMA_CHANNEL);
+    dma_enable_transfer_complete_interrupt(DMA1, ADC_DMA_CHANNEL);
+    nvic_set_priority(ADC_DMA_IRQ, NVIC_PRIO_ADC);
+    nvic_enable_irq(ADC_DMA_IRQ);
 
     // start conversion:
     adc_dma_arm();
 }
 
+static void adc_init_timer(void) {
+    debug("adc: init timer\n"); debug_flush();
 
-static void adc_dma_arm(void) {
-    // start conversion
-    dma_enable_channel(DMA1, ADC_DMA_CHANNEL);
-    adc_start_conversion_regular(ADC1);
-}
+    rcc_periph_clock_enable(RCC_TIM15);
+    timer_reset(TIM15);
 
-void adc_process(void) {
-    // adc dma finished?
-    if (dma_get_interrupt_flag(DMA1, ADC_DMA_CHANNEL, ADC_DMA_TC_FLAG)) {
-        dma_clear_interrupt_flags(DMA1, ADC_DMA_CHANNEL, ADC_DMA_TC_FLAG);
-        if (adc_battery_voltage_raw_filtered == 0) {
-            // initialise with current value
-            adc_battery_voltage_raw_filtered = adc_data[10];
-        } else {
-            // low pass filter battery voltage
-            adc_battery_voltage_raw_filtered = adc_battery_voltage_raw_filtered +
-                                     (4 * (adc_data[10] - adc_battery_voltage_raw_filtered)) / 128;
-        }
+    // a prescaler so that one timer tick is 1us (1MHz)
+    timer_set_prescaler(TIM15, (rcc_timer_frequency / 1000000) - 1);
 
-        // fine, arm DMA again:
-        adc_dma_arm();
+    // every compare match of oc1 (once per period) starts an adc sequence
+    timer_set_oc_mode(TIM15, TIM_OC1, TIM_OCM_FROZEN);
+    timer_set_oc_value(TIM15, TIM_OC1, 1);
+    timer_set_master_mode(TIM15, TIM_CR2_MMS_COMPARE_PULSE);
+
+    adc_set_frame_sync(0);
+}
+
+// callback = 0: TIM15 runs free and triggers the adc continuously.
+// otherwise TIM15 is started by TIM3 TRGO (oc2ref, see frsky_init_timer)
+// and fires exactly ADC_OVERSAMPLE sequences = one half of the dma buffer.
+// the callback is executed once that burst was processed
+void adc_set_frame_sync(adc_callback_t callback) {
+    timer_disable_counter(TIM15);
+
+    adc_snapshot_callback = 0;
+
+    if (callback) {
+        // one pulse mode, stop after ADC_OVERSAMPLE periods
+        timer_one_shot_mode(TIM15);
+        timer_set_repetition_counter(TIM15, ADC_OVERSAMPLE - 1);
+        timer_set_period(TIM15, ADC_BURST_INTERVAL_US - 1);
+        // TIM15 ITR1 = TIM3 TRGO, a rising edge starts the counter
+        timer_slave_set_trigger(TIM15, TIM_SMCR_TS_ITR1);
+        timer_slave_set_mode(TIM15, TIM_SMCR_SMS_TM);
     } else {
-        // oops this should not happen
-        debug_putc('D');
-        // cancel and re arm dma ???
+        timer_slave_set_mode(TIM15, TIM_SMCR_SMS_OFF);
+        timer_continuous_mode(TIM15);
+        timer_set_repetition_counter(TIM15, 0);
+        timer_set_period(TIM15, (1000000 / (ADC_SAMPLE_RATE_HZ * ADC_OVERSAMPLE)) - 1);
+    }
+
+    // load prescaler and repetition counter
+    timer_generate_event(TIM15, TIM_EGR_UG);
+
+    // a burst has to fill exactly one half of the dma buffer
+    adc_dma_realign();
+
+    adc_snapshot_callback = callback;
+
+    if (!callback) {
+        timer_enable_counter(TIM15);
     }
 }
 
+static void adc_dma_realign(void) {
+    // abort the running sequence
+    if (ADC_CR(ADC1) & ADC_CR_ADSTART) {
+        ADC_CR(ADC1) |= ADC_CR_ADSTP;
+        while (ADC_CR(ADC1) & ADC_CR_ADSTP) {}
+    }
+
+    // restart the dma at the first half
+    dma_disable_channel(DMA1, ADC_DMA_CHANNEL);
+    dma_set_number_of_data(DMA1, ADC_DMA_CHANNEL, 2 * ADC_OVERSAMPLE * ADC_CHANNEL_COUNT);
+    dma_clear_interrupt_flags(DMA1, ADC_DMA_CHANNEL, DMA_HTIF | DMA_TCIF);
+
+    adc_dma_arm();
+}
+
+static void adc_dma_arm(void) {
+    // start conversion, the sequence waits for the timer trigger
+    dma_enable_channel(DMA1, ADC_DMA_CHANNEL);
+    adc_start_conversion_regular(ADC1);
+}
+
 void adc_test(void) {
     while (1) {
         console_clear();
@@ -333,7 +608,6 @@ void adc_test(void) {
         debug_put_fixed2(adc_get_battery_voltage());
         debug(" V\n");
         uint32_t i;
-        adc_process();
         for (i = 0; i < ADC_CHANNEL_COUNT; i++) {
             debug_put_uint8(i+0); debug_putc('=');
             debug_put_hex16(adc_get_channel(i+0));
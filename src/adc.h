@@ -26,12 +26,12 @@
 void adc_init(void);
 void adc_test(void);
 
-void adc_process(void);
-
 uint16_t adc_get_channel(uint32_t id);
 int32_t  adc_get_channel_rescaled(uint8_t idx);
 uint16_t adc_get_channel_packetdata(uint8_t idx);
 uint32_t adc_get_battery_voltage(void);
+int16_t adc_get_temperature(void);
+void adc_calibration_update(void);
 
 // internal channel ordering. we will always use AETR0123 internally
 typedef enum {
@@ -48,6 +48,25 @@ typedef enum {
 
 char *adc_get_channel_name(uint8_t i, bool short_descr);
 
+// all channels, calculated once after every completed adc dma cycle.
+// sequence is a seqlock, incremented before and after the update (odd = busy)
+typedef struct {
+    uint32_t sequence;
+    // rftiming_now() when the snapshot was completed
+    uint32_t timestamp;
+    uint16_t raw[CHANNEL_ID_SIZE];
+    int16_t  rescaled[CHANNEL_ID_SIZE];
+    uint16_t packetdata[CHANNEL_ID_SIZE];
+    // logical switches, bit n = switch n
+    uint32_t switches;
+} adc_snapshot_t;
+
+void adc_get_snapshot(adc_snapshot_t *snapshot);
+uint32_t adc_get_snapshot_sequence(void);
+
+typedef void (*adc_callback_t)(void);
+void adc_set_frame_sync(adc_callback_t callback);
+
 
 // rescaled data goes from -3200 to 3200
 // set zero threshold to 10% movement from absolute zero
@@ -56,5 +75,25 @@ char *adc_get_channel_name(uint8_t i, bool short_descr);
 #define ADC_RESCALED_ZERO_THRESHOLD      (ADC_RESCALED_ABSOLUTE_MIN + 0.1 * \
                                          (ADC_RESCALED_ABSOLUTE_MAX - ADC_RESCALED_ABSOLUTE_MIN))
 
+#define ADC_RESCALE_TARGET_RANGE 3200
+// stick calibration coefficients are (range << SHIFT) / divider,
+// a minimum divider keeps value * coef within 32 bit
+#define ADC_RESCALE_COEF_SHIFT   12
+#define ADC_RESCALE_DIVIDER_MIN  64
+
+// snapshot rate. TIM15 triggers ADC_OVERSAMPLE sequences per snapshot
+#define ADC_SAMPLE_RATE_HZ 1000
+#define ADC_OVERSAMPLE_SHIFT 2
+#define ADC_OVERSAMPLE (1 << ADC_OVERSAMPLE_SHIFT)
+// frame sync: sequence spacing within one burst, one sequence takes 68us
+#define ADC_BURST_INTERVAL_US 80
+// trigger to snapshot: (ADC_OVERSAMPLE - 1) intervals + one sequence + isr
+#define ADC_BURST_DURATION_US ((ADC_OVERSAMPLE - 1) * ADC_BURST_INTERVAL_US + 100)
+// decimated values are smoothed by y += (x - y) >> IIR_SHIFT
+#define ADC_FILTER_FP_SHIFT 4
+#define ADC_FILTER_IIR_SHIFT 1
+#define ADC_FILTER_IIR_SHIFT_TEMPERATURE 5
+#define ADC_BATTERY_FILTER_SHIFT 8
+
 
 #endif  // ADC_H_
@@ -22,13 +22,36 @@
 
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/exti.h>
 
 #include "debug.h"
 #include "timeout.h"
+#include "macros.h"
 #include <string.h>
 
 // internal functions
 static void cc2500_init_gpio(void);
+static void cc2500_init_rx_interrupt(void);
+static cc2500_transfer_t *cc2500_queue_alloc(void);
+static void cc2500_queue_commit(void);
+static void cc2500_queue_start(void);
+static void cc2500_queue_pa_on(uint8_t *data, uint8_t len);
+static void cc2500_queue_pa_off(uint8_t *data, uint8_t len);
+static void cc2500_rx_rxbytes_done(uint8_t *data, uint8_t len);
+static void cc2500_rx_queue_rxbytes(void);
+static void cc2500_rx_fifo_done(uint8_t *data, uint8_t len);
+
+// async transfer queue
+static cc2500_transfer_t cc2500_queue[CC2500_QUEUE_SIZE];
+static volatile uint8_t cc2500_queue_head;
+static volatile uint8_t cc2500_queue_tail;
+static volatile uint8_t cc2500_queue_busy;
+static volatile uint32_t cc2500_queue_overflow_count;
+
+// packet receive interrupt
+static uint8_t cc2500_rx_len;
+static uint8_t cc2500_rx_retry;
+static cc2500_callback_t cc2500_rx_callback;
 
 
 #define CC2500_DEBUG_STATUSBYTE 0
@@ -37,6 +60,13 @@ void cc2500_init(void) {
     debug("cc2500: init\n"); debug_flush();
     cc2500_init_gpio();
     spi_init();
+
+    cc2500_queue_head = 0;
+    cc2500_queue_tail = 0;
+    cc2500_queue_busy = 0;
+    cc2500_queue_overflow_count = 0;
+
+    cc2500_init_rx_interrupt();
 }
 
 static void cc2500_init_gpio(void) {
@@ -78,6 +108,24 @@ static void cc2500_init_gpio(void) {
     gpio_set_output_options(CC2500_GDO2_GPIO, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, CC2500_GDO2_PIN);
 }
 
+static void cc2500_init_rx_interrupt(void) {
+    // gdo2 goes high when a packet was received (see cc2500_set_gdo_mode)
+
+    // clock for syscfg
+    rcc_periph_clock_enable(RCC_SYSCFG_COMP);
+
+    // connect EXTI2 Line to gdo2, rising edge
+    exti_select_source(CC2500_GDO2_EXTI_SOURCE_LINE, CC2500_GDO2_EXTI_SOURCE);
+    exti_set_trigger(CC2500_GDO2_EXTI_SOURCE_LINE, EXTI_TRIGGER_RISING);
+
+    // start disabled, see cc2500_rx_interrupt_enable()
+    exti_disable_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+
+    // same prio as the rf isr, this way the queue is never accessed concurrently
+    nvic_set_priority(CC2500_GDO2_EXTI_IRQN, NVIC_PRIO_FRSKY);
+    nvic_enable_irq(CC2500_GDO2_EXTI_IRQN);
+}
+
 inline void cc2500_enter_rxmode(void) {
     // LNA = 1, PA = 0
     gpio_set(CC2500_LNA_GPIO, CC2500_LNA_PIN);  // 1
@@ -104,7 +152,8 @@ inline void cc2500_set_gdo_mode(void) {
     // set to RX FIFO signal
     cc2500_set_register(IOCFG0, 0x01);
     // cc2500_set_register(IOCFG1, 0x02); //
-    cc2500_set_register(IOCFG2, 0x02);
+    // gdo2 triggers the packet receive interrupt
+    cc2500_set_register(IOCFG2, 0x01);
 }
 
 inline void cc2500_set_register(uint8_t address, uint8_t data) {
@@ -265,6 +314,62 @@ inline void cc2500_register_write_multi(uint8_t address, uint8_t *buffer, uint8_
     cc2500_csn_hi();
 }
 
+void cc2500_load_profile(const cc2500_profile_t *profile) {
+    // the dma transfer writes the received status bytes back into the
+    // buffer, thus we can not send directly from flash
+    uint8_t buffer[CC2500_PROFILE_REGISTER_COUNT];
+
+    debug("cc2500: load profile ");
+    debug(profile->name);
+    debug_put_newline();
+    debug_flush();
+
+    memcpy(buffer, profile->reg, CC2500_PROFILE_REGISTER_COUNT);
+
+    // registers are only writeable in idle state
+    cc2500_strobe(RFST_SIDLE);
+
+    // all config registers in one burst starting at IOCFG2
+    cc2500_register_write_multi(IOCFG2, buffer, CC2500_PROFILE_REGISTER_COUNT);
+    cc2500_set_register(PA_TABLE0, profile->pa_table0);
+}
+
+// read back all config registers and compare them with the profile
+// returns the number of mismatching registers
+uint8_t cc2500_verify_profile(const cc2500_profile_t *profile) {
+    uint8_t buffer[CC2500_PROFILE_REGISTER_COUNT];
+    uint8_t errors = 0;
+    uint8_t i;
+
+    cc2500_register_read_multi(IOCFG2 | READ_FLAG | BURST_FLAG, buffer, CC2500_PROFILE_REGISTER_COUNT);
+
+    for (i = 0; i < CC2500_PROFILE_REGISTER_COUNT; i++) {
+        // the fscal registers are overwritten by every calibration
+        if ((i >= FSCAL3) && (i <= FSCAL0)) {
+            continue;
+        }
+        if (buffer[i] != profile->reg[i]) {
+            debug("cc2500: verify 0x");
+            debug_put_hex8(i);
+            debug(" = 0x");
+            debug_put_hex8(buffer[i]);
+            debug(" != 0x");
+            debug_put_hex8(profile->reg[i]);
+            debug_put_newline();
+            debug_flush();
+            errors++;
+        }
+    }
+
+    if (cc2500_get_register(PA_TABLE0) != profile->pa_table0) {
+        debug("cc2500: verify pa table failed\n");
+        debug_flush();
+        errors++;
+    }
+
+    return errors;
+}
+
 inline void cc2500_process_packet(volatile uint8_t *packet_received, volatile uint8_t *buffer, \
                                   uint8_t maxlen) {
     if (cc2500_get_gdo_status() == 1) {
@@ -316,6 +421,261 @@ void cc2500_transmit_packet(volatile uint8_t *buffer, uint8_t len) {
     cc2500_strobe(RFST_STX);
 }
 
+static cc2500_transfer_t *cc2500_queue_alloc(void) {
+    // queue full?
+    if (((cc2500_queue_head + 1) & CC2500_QUEUE_MASK) == cc2500_queue_tail) {
+        cc2500_queue_overflow_count++;
+        return 0;
+    }
+
+    return &cc2500_queue[cc2500_queue_head];
+}
+
+static void cc2500_queue_commit(void) {
+    cc2500_queue_head = (cc2500_queue_head + 1) & CC2500_QUEUE_MASK;
+
+    // kick off the transfer if the queue was idle. when called from
+    // a callback the queue is still busy and continues on its own
+    if (!cc2500_queue_busy) {
+        cc2500_queue_start();
+    }
+}
+
+static void cc2500_queue_start(void) {
+    cc2500_transfer_t *transfer;
+
+    cc2500_queue_busy = 1;
+
+    while (cc2500_queue_tail != cc2500_queue_head) {
+        transfer = &cc2500_queue[cc2500_queue_tail];
+
+        if (transfer->len) {
+            // select device. no need to wait for the ready signal,
+            // the crystal is never powered down while the queue is in use
+            gpio_clear(CC2500_SPI_GPIO, CC2500_SPI_CSN_PIN);
+
+            // the rest is done by the dma isr
+            spi_dma_xfer_async(transfer->data, transfer->len);
+            return;
+        }
+
+        // call only entry, execute and continue with the next one
+        if (transfer->callback) {
+            transfer->callback(0, 0);
+        }
+        cc2500_queue_tail = (cc2500_queue_tail + 1) & CC2500_QUEUE_MASK;
+    }
+
+    cc2500_queue_busy = 0;
+}
+
+void cc2500_queue_xfer_done(void) {
+    cc2500_transfer_t *transfer = &cc2500_queue[cc2500_queue_tail];
+
+    // deselect device
+    gpio_set(CC2500_SPI_GPIO, CC2500_SPI_CSN_PIN);
+
+    if (transfer->callback) {
+        // skip the status byte
+        transfer->callback(&transfer->data[1], transfer->len - 1);
+    }
+
+    // free this slot only now, the callback works on its data
+    cc2500_queue_tail = (cc2500_queue_tail + 1) & CC2500_QUEUE_MASK;
+
+    // continue with the next transfer
+    cc2500_queue_start();
+}
+
+uint32_t cc2500_queue_idle(void) {
+    return !cc2500_queue_busy;
+}
+
+uint32_t cc2500_queue_get_overflow_count(void) {
+    return cc2500_queue_overflow_count;
+}
+
+void cc2500_queue_strobe(uint8_t address) {
+    cc2500_transfer_t *transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    transfer->data[0] = address;
+    transfer->len = 1;
+    transfer->callback = 0;
+    cc2500_queue_commit();
+}
+
+void cc2500_queue_set_register(uint8_t address, uint8_t data) {
+    cc2500_transfer_t *transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    transfer->data[0] = address;
+    transfer->data[1] = data;
+    transfer->len = 2;
+    transfer->callback = 0;
+    cc2500_queue_commit();
+}
+
+void cc2500_queue_register_read(uint8_t address, uint8_t len, cc2500_callback_t callback) {
+    cc2500_transfer_t *transfer;
+
+    if (len >= CC2500_QUEUE_DATA_SIZE) return;
+
+    transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    // request address(read request has bit7 set) and fill with read commands
+    transfer->data[0] = address | READ_FLAG;
+    memset(&transfer->data[1], 0xFF, len);
+    transfer->len = len + 1;
+    transfer->callback = callback;
+    cc2500_queue_commit();
+}
+
+void cc2500_queue_register_write_multi(uint8_t address, volatile uint8_t *buffer, uint8_t len) {
+    cc2500_transfer_t *transfer;
+    uint8_t i;
+
+    if (len >= CC2500_QUEUE_DATA_SIZE) return;
+
+    transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    // copy the data, the caller may modify the buffer right after this call
+    transfer->data[0] = address | BURST_FLAG;
+    for (i = 0; i < len; i++) {
+        transfer->data[1 + i] = buffer[i];
+    }
+    transfer->len = len + 1;
+    transfer->callback = 0;
+    cc2500_queue_commit();
+}
+
+// queue a preformatted frame (header bytes included) as one burst.
+// after a single register access or a strobe the cc2500 expects a new
+// header byte, thus several of them can be chained while csn stays low.
+// a burst access has to be the last one in such a frame.
+void cc2500_queue_write_raw(const uint8_t *buffer, uint8_t len) {
+    cc2500_transfer_t *transfer;
+
+    if (len > CC2500_QUEUE_DATA_SIZE) return;
+
+    transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    memcpy(transfer->data, buffer, len);
+    transfer->len = len;
+    transfer->callback = 0;
+    cc2500_queue_commit();
+}
+
+void cc2500_queue_transmit_packet(volatile uint8_t *buffer, uint8_t len) {
+    // flush tx fifo
+    cc2500_queue_strobe(RFST_SFTX);
+    // copy to fifo
+    cc2500_queue_register_write_multi(CC2500_FIFO, buffer, len);
+    // and send!
+    cc2500_queue_strobe(RFST_STX);
+}
+
+void cc2500_queue_call(cc2500_callback_t callback) {
+    cc2500_transfer_t *transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    transfer->len = 0;
+    transfer->callback = callback;
+    cc2500_queue_commit();
+}
+
+static void cc2500_queue_pa_on(uint8_t *UNUSED(data), uint8_t UNUSED(len)) {
+    gpio_set(CC2500_PA_GPIO, CC2500_PA_PIN);
+}
+
+static void cc2500_queue_pa_off(uint8_t *UNUSED(data), uint8_t UNUSED(len)) {
+    gpio_clear(CC2500_PA_GPIO, CC2500_PA_PIN);
+}
+
+// same as cc2500_enter_rx/txmode() but without the delays:
+// the second pin is switched from the queue, after the
+// transfers queued so far, which gives the same break before make
+void cc2500_queue_enter_rxmode(void) {
+    // LNA = 1, PA = 0
+    gpio_set(CC2500_LNA_GPIO, CC2500_LNA_PIN);
+    cc2500_queue_call(cc2500_queue_pa_off);
+}
+
+void cc2500_queue_enter_txmode(void) {
+    // LNA = 0, PA = 1
+    gpio_clear(CC2500_LNA_GPIO, CC2500_LNA_PIN);
+    cc2500_queue_call(cc2500_queue_pa_on);
+}
+
+void cc2500_rx_interrupt_enable(uint8_t len, cc2500_callback_t callback) {
+    cc2500_rx_len = len;
+    cc2500_rx_callback = callback;
+
+    exti_reset_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+    exti_enable_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+}
+
+void cc2500_rx_interrupt_disable(void) {
+    exti_disable_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+    exti_reset_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+}
+
+static void cc2500_rx_queue_rxbytes(void) {
+    cc2500_transfer_t *transfer = cc2500_queue_alloc();
+    if (!transfer) return;
+
+    // there is a bug in the cc2500
+    // see p3 http:// www.ti.com/lit/er/swrz002e/swrz002e.pdf
+    // workaround: read len register very quickly twice.
+    // status registers only allow single access, thus csn
+    // can stay low and we get both values with one transfer
+    transfer->data[0] = RXBYTES | READ_FLAG;
+    transfer->data[1] = 0xFF;
+    transfer->data[2] = RXBYTES | READ_FLAG;
+    transfer->data[3] = 0xFF;
+    transfer->len = 4;
+    transfer->callback = cc2500_rx_rxbytes_done;
+    cc2500_queue_commit();
+}
+
+static void cc2500_rx_rxbytes_done(uint8_t *data, uint8_t UNUSED(len)) {
+    // data[0] = len1, data[1] = status, data[2] = len2
+    uint8_t len1 = data[0] & 0x7F;
+    uint8_t len2 = data[2] & 0x7F;
+
+    if (len1 != len2) {
+        // try this 10 times befor giving up
+        if (cc2500_rx_retry++ < 10) {
+            cc2500_rx_queue_rxbytes();
+        }
+        return;
+    }
+
+    // only accept valid packet lengths
+    if (len1 == cc2500_rx_len) {
+        cc2500_queue_register_read(CC2500_FIFO | BURST_FLAG, cc2500_rx_len, cc2500_rx_fifo_done);
+    }
+}
+
+static void cc2500_rx_fifo_done(uint8_t *data, uint8_t len) {
+    if (cc2500_rx_callback) {
+        cc2500_rx_callback(data, len);
+    }
+}
+
+void EXTI2_3_IRQHandler(void) {
+    if (exti_get_flag_status(CC2500_GDO2_EXTI_SOURCE_LINE) != 0) {
+        exti_reset_request(CC2500_GDO2_EXTI_SOURCE_LINE);
+
+        // packet received, fetch the length and then the data
+        cc2500_rx_retry = 0;
+        cc2500_rx_queue_rxbytes();
+    }
+}
+
 /*
 void cc2500_wait_for_transmission_complete(void) {
     // after STX we go back to RX state(see MCSM1 register)
@@ -53,8 +53,47 @@ void cc2500_transmit_packet(volatile uint8_t *buffer, uint8_t len);
 
 void cc2500_read_fifo(uint8_t *buf, uint8_t len);
 void cc2500_register_read_multi(uint8_t address, uint8_t *buffer, uint8_t len);
+void cc2500_register_write_multi(uint8_t address, uint8_t *buffer, uint8_t len);
 uint8_t cc2500_transmission_completed(void);
 
+// asynchronous transfer queue
+// all cc2500 accesses from within the rf isr are queued here and executed
+// back to back by the spi dma transfer complete isr. each queue entry is one
+// csn frame. the callback is executed once the frame was transferred, it
+// gets the data read back (without the status byte) and may queue more work.
+// entries with len = 0 only execute the callback (used for pa/lna switching).
+// NOTE: never mix the blocking functions above with the queue, the queue
+//       is only used while the rf isr is active
+#define CC2500_QUEUE_SIZE      16
+#define CC2500_QUEUE_MASK      (CC2500_QUEUE_SIZE - 1)
+#define CC2500_QUEUE_DATA_SIZE 32  // d16 frame + fifo address
+
+typedef void (*cc2500_callback_t)(uint8_t *data, uint8_t len);
+
+typedef struct {
+    uint8_t data[CC2500_QUEUE_DATA_SIZE];
+    uint8_t len;
+    cc2500_callback_t callback;
+} cc2500_transfer_t;
+
+void cc2500_queue_strobe(uint8_t address);
+void cc2500_queue_set_register(uint8_t address, uint8_t data);
+void cc2500_queue_register_read(uint8_t address, uint8_t len, cc2500_callback_t callback);
+void cc2500_queue_register_write_multi(uint8_t address, volatile uint8_t *buffer, uint8_t len);
+void cc2500_queue_transmit_packet(volatile uint8_t *buffer, uint8_t len);
+void cc2500_queue_write_raw(const uint8_t *buffer, uint8_t len);
+void cc2500_queue_call(cc2500_callback_t callback);
+void cc2500_queue_enter_rxmode(void);
+void cc2500_queue_enter_txmode(void);
+uint32_t cc2500_queue_idle(void);
+uint32_t cc2500_queue_get_overflow_count(void);
+void cc2500_queue_xfer_done(void);
+
+// packet receive interrupt (gdo2)
+// the callback is executed from the queue once a packet of len bytes was read
+void cc2500_rx_interrupt_enable(uint8_t len, cc2500_callback_t callback);
+void cc2500_rx_interrupt_disable(void);
+
 // adress checks
 #define CC2500_PKTCTRL1_FLAG_ADR_CHECK_00 ((0<<1) | (0<<0))
 #define CC2500_PKTCTRL1_FLAG_ADR_CHECK_01 ((0<<1) | (1<<0))
@@ -180,6 +219,20 @@ uint8_t cc2500_transmission_completed(void);
 
 #define PA_TABLE0  0x3E
 
+// register profile: a full image of the config registers IOCFG2..TEST0
+// stored in flash. it is loaded with a single dma burst write, the pa table
+// entry is set afterwards (burst access to 0x3E would address the pa table)
+#define CC2500_PROFILE_REGISTER_COUNT (TEST0 + 1)
+
+typedef struct {
+    char *name;
+    uint8_t reg[CC2500_PROFILE_REGISTER_COUNT];
+    uint8_t pa_table0;
+} cc2500_profile_t;
+
+void cc2500_load_profile(const cc2500_profile_t *profile);
+uint8_t cc2500_verify_profile(const cc2500_profile_t *profile);
+
 // FIFO
 #define CC2500_FIFO     0x3F
 
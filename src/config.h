@@ -74,6 +74,11 @@ void config_detect_hw_revision(void);
 // CS
 #define LCD_CS_GPIO          GPIOD
 #define LCD_CS_PIN           GPIO2
+// dma transfer engine: TIM16 (remapped to ch4) writes the data bytes,
+// TIM17 (remapped to ch7) the rd strobes. the TIM17 irq signals completion
+#define LCD_DMA_DATA_CHANNEL   DMA_CHANNEL4
+#define LCD_DMA_STROBE_CHANNEL DMA_CHANNEL7
+#define LCD_DMA_IRQ            NVIC_TIM17_IRQ
 
 // speaker
 #define SPEAKER_GPIO         GPIOA
@@ -83,6 +88,9 @@ void config_detect_hw_revision(void);
 #define NVIC_PRIO_FRSKY      0*64
 #define NVIC_PRIO_SYSTICK    1*64
 #define NVIC_PRIO_TOUCH      3*64
+#define NVIC_PRIO_FRSKY_BOTTOM_HALF 3*64
+#define NVIC_PRIO_ADC        2*64
+#define NVIC_PRIO_LCD        3*64
 
 // touch
 #define TOUCH_FT6236_I2C_ADDRESS      (0x70>>1)
@@ -106,7 +114,15 @@ void config_detect_hw_revision(void);
 
 #define ADC_DMA_CHANNEL           DMA_CHANNEL1
 #define ADC_DMA_TC_FLAG           DMA_ISR_TCIF1
-#define ADC_CHANNEL_COUNT 11
+#define ADC_DMA_IRQ               NVIC_DMA1_CHANNEL1_IRQ
+#define ADC_CHANNEL_COUNT 12
+// battery voltage divider on PC0 (ADC10)
+#define ADC_CHANNEL_BATTERY_INDEX 10
+// internal temperature sensor, last in the sequence
+#define ADC_CHANNEL_TEMPERATURE_INDEX 11
+// factory calibration at 30 and 110 deg C (Vdda = 3.3V)
+#define ADC_TS_CAL1 (*(uint16_t *)0x1FFFF7B8)
+#define ADC_TS_CAL2 (*(uint16_t *)0x1FFFF7C2)
 
 // cc2500 module connection
 // SI = SDIO
@@ -149,6 +165,9 @@ void config_detect_hw_revision(void);
 // LABELED GIO2
 #define CC2500_GDO2_GPIO           GPIOB
 #define CC2500_GDO2_PIN            GPIO2
+#define CC2500_GDO2_EXTI_SOURCE       GPIOB
+#define CC2500_GDO2_EXTI_SOURCE_LINE  EXTI2
+#define CC2500_GDO2_EXTI_IRQN         NVIC_EXTI2_3_IRQ
 
 // BUTTONS
 #define BUTTON_POWER_BOTH_GPIO        GPIOB
@@ -26,6 +26,16 @@ static char console_buffer[CONSOLE_BUFFER_SIZE_Y][CONSOLE_BUFFER_SIZE_X+1];
 static uint8_t console_write_x;
 static uint8_t console_write_y;
 
+// hardware scroll mode: one console line per lcd page, the lcd start
+// line moves up by one page for every new line
+static uint8_t console_scroll_active;
+// buffer line shown on the bottom page and its lcd page
+static uint8_t console_scroll_y;
+static uint8_t console_scroll_page;
+
+// internal functions
+static void console_render_page(uint8_t page, uint8_t color, char *str);
+
 void console_init(void) {
     // initialise console
     console_clear();
@@ -104,6 +114,9 @@ void console_render(void) {
     uint32_t i;
     uint8_t  color = CONSOLE_TEXTCOLOR;
 
+    // full redraw, back to the normal start line
+    console_scroll_stop();
+
     // fill screen with inverse of color
     screen_fill(1-color);
 
@@ -124,4 +137,45 @@ void console_render(void) {
     }
 }
 
+void console_scroll_stop(void) {
+    if (console_scroll_active) {
+        console_scroll_active = 0;
+        lcd_set_startline(0);
+    }
+}
+
+static void console_render_page(uint8_t page, uint8_t color, char *str) {
+    screen_fill_rect(0, page * 8, LCD_WIDTH, 8, 1-color);
+    screen_set_font(CONSOLE_FONT, 0, 0);
+    screen_puts_xy(1, page * 8 + 1, color, str);
+}
 
+// same as console_render() + screen_update() but the controller ram is
+// scrolled in hardware: only the lines written since the last call are
+// rendered, and screen_update() only sends their pages
+void console_render_scroll(void) {
+    uint8_t color = CONSOLE_TEXTCOLOR;
+
+    if (!console_scroll_active) {
+        // start with an empty screen and the last lines of the buffer
+        screen_fill(1-color);
+        console_scroll_y = (console_write_y + CONSOLE_BUFFER_SIZE_Y - (LCD_PAGES - 1))
+                           % CONSOLE_BUFFER_SIZE_Y;
+        console_scroll_page = 0;
+        console_scroll_active = 1;
+    }
+
+    // finish all lines above the current one, scroll up by one page each
+    while (console_scroll_y != console_write_y) {
+        console_render_page(console_scroll_page, color, console_buffer[console_scroll_y]);
+        console_scroll_y = (console_scroll_y + 1) % CONSOLE_BUFFER_SIZE_Y;
+        console_scroll_page = (console_scroll_page + 1) % LCD_PAGES;
+    }
+
+    // the current line is shown on the bottom page
+    console_render_page(console_scroll_page, color, console_buffer[console_write_y]);
+    screen_update();
+
+    // the page after the bottom one is the top line of the display
+    lcd_set_startline(((console_scroll_page + 1) % LCD_PAGES) * 8);
+}
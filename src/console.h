@@ -33,11 +33,13 @@ void console_clear(void);
 void console_puts(char *str);
 void console_putc(char c);
 void console_render(void);
+void console_render_scroll(void);
+void console_scroll_stop(void);
 
 // you can define the console font here. make sure to use FIXED WIDTH fonts!
 // make sure to set width and height properly
-// #define CONSOLE_FONT font_system5x7
-#define CONSOLE_FONT font_tomthumb3x5
+// #define CONSOLE_FONT (&font_system5x7)
+#define CONSOLE_FONT (&font_tomthumb3x5)
 #define CONSOLE_FONT_WIDTH  3
 #define CONSOLE_FONT_HEIGHT 5
 
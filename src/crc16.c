@@ -25,6 +25,12 @@ static const uint16_t crc16_table[16] = {
   0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F
 };
 
+// lookup table for crc16 CCITT, msb first (xmodem), used by frsky d16
+static const uint16_t crc16_ccitt_table[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
 static uint16_t crc16_update(uint16_t crc, uint8_t c) {
     crc = (((crc >> 4) & 0x0FFF) ^ crc16_table[((crc ^ c) & 0x000F)]);
     crc = (((crc >> 4) & 0x0FFF) ^ crc16_table[((crc ^ (c>>4)) & 0x000F)]);
@@ -38,3 +44,17 @@ uint16_t crc16(uint8_t *buf, uint16_t len) {
     }
     return crc;
 }
+
+static uint16_t crc16_ccitt_update(uint16_t crc, uint8_t c) {
+    crc = (crc << 4) ^ crc16_ccitt_table[((crc >> 12) ^ (c >> 4)) & 0x000F];
+    crc = (crc << 4) ^ crc16_ccitt_table[((crc >> 12) ^ c) & 0x000F];
+    return crc;
+}
+
+uint16_t crc16_ccitt(uint8_t *buf, uint16_t len) {
+    uint16_t crc = 0;
+    while (len--) {
+        crc = crc16_ccitt_update(crc, *buf++);
+    }
+    return crc;
+}
@@ -58,10 +58,10 @@ void debug_flush(void) {
     if (!gui_running()) {
         // if gui is not yet active, render console now
         if (adc_get_channel_rescaled(CHANNEL_ID_CH3) < 0) {
-            // show console on switch down
-            console_render();
-            screen_update();
+            // show console on switch down, scrolled in hardware
+            console_render_scroll();
         } else {
+            console_scroll_stop();
             lcd_show_logo();
         }
     }
@@ -31,6 +31,14 @@ uint16_t EE_virtual_address_table[EE_NB_OF_VAR];
 
 #include "eeprom_emulation/st_eeprom.h"
 
+// a page holds one record (address + value) per 4 bytes, minus the page header.
+// after a page transfer only the records not taken by the storage are free for
+// updates, keep a quarter of the page for them or transfers (and erases) get frequent
+#define EEPROM_RECORDS_PER_PAGE ((EEPROM_PAGE_SIZE / 4) - 1)
+#define EEPROM_RECORDS_RESERVED (EEPROM_RECORDS_PER_PAGE / 4)
+_Static_assert(EE_NB_OF_VAR <= (EEPROM_RECORDS_PER_PAGE - EEPROM_RECORDS_RESERVED),
+               "storage does not fit the eeprom emulation page");
+
 void eeprom_init(void) {
     debug("eeprom: init\n"); debug_flush();
 
@@ -43,21 +43,21 @@
 /****************************************************************************
 * DESCRIPTION: Returns the number of elements in the ring buffer
 * RETURN:      Number of elements in the ring buffer
-* ALGORITHM:   none
+* ALGORITHM:   the indices run freely, the difference wraps correctly
 * NOTES:       none
 *****************************************************************************/
-static inline unsigned fifo_count(fifo_buffer_t const *b ) {
+unsigned fifo_count(fifo_buffer_t const *b) {
     return (b ? (b->head - b->tail) : 0);
 }
 
 /****************************************************************************
-* DESCRIPTION: Returns the empty/full status of the ring buffer
-* RETURN:      true if the ring buffer is full, false if it is not.
+* DESCRIPTION: Returns the free space in the ring buffer
+* RETURN:      Number of bytes that can be added
 * ALGORITHM:   none
 * NOTES:       none
 *****************************************************************************/
-static bool fifo_full(fifo_buffer_t const *b) {
-    return (b ? (fifo_count(b) == b->buffer_len) : true);
+unsigned fifo_space(fifo_buffer_t const *b) {
+    return (b ? (b->mask + 1 - fifo_count(b)) : 0);
 }
 
 /****************************************************************************
@@ -78,7 +78,7 @@ bool fifo_empty(fifo_buffer_t const *b) {
 *****************************************************************************/
 uint8_t fifo_peek(fifo_buffer_t const *b) {
     if (b) {
-        return (b->buffer[b->tail % b->buffer_len]);
+        return (b->buffer[b->tail & b->mask]);
     }
 
     return 0;
@@ -94,7 +94,9 @@ uint8_t fifo_get(fifo_buffer_t * b) {
     uint8_t data_byte = 0;
 
     if (!fifo_empty(b)) {
-        data_byte = b->buffer[b->tail % b->buffer_len];
+        /* read the byte before the producer may reuse the slot */
+        data_byte = b->buffer[b->tail & b->mask];
+        FIFO_BARRIER();
         b->tail++;
     }
     return data_byte;
@@ -111,8 +113,10 @@ bool fifo_put(fifo_buffer_t * b, uint8_t data_byte) {
 
     if (b) {
         /* limit the ring to prevent overwriting */
-        if (!fifo_full(b)) {
-            b->buffer[b->head % b->buffer_len] = data_byte;
+        if (fifo_space(b)) {
+            /* store the byte before the consumer can see it */
+            b->buffer[b->head & b->mask] = data_byte;
+            FIFO_BARRIER();
             b->head++;
             status = true;
         }
@@ -121,6 +125,68 @@ bool fifo_put(fifo_buffer_t * b, uint8_t data_byte) {
     return status;
 }
 
+/****************************************************************************
+* DESCRIPTION: Adds len bytes of data to the FIFO
+* RETURN:      true on succesful add, false if not added
+* ALGORITHM:   copy everything, then publish the new head once
+* NOTES:       nothing is added if the data does not fit
+*****************************************************************************/
+bool fifo_put_multi(fifo_buffer_t * b, const uint8_t *data, unsigned len) {
+    unsigned head, i;
+
+    if (!b || (fifo_space(b) < len)) {
+        return false;
+    }
+
+    head = b->head;
+    for (i = 0; i < len; i++) {
+        b->buffer[(head + i) & b->mask] = data[i];
+    }
+    FIFO_BARRIER();
+    b->head = head + len;
+
+    return true;
+}
+
+/****************************************************************************
+* DESCRIPTION: Gets up to len bytes from the front of the list
+* RETURN:      number of bytes copied to data
+* ALGORITHM:   copy everything, then release the space once
+* NOTES:       none
+*****************************************************************************/
+unsigned fifo_get_multi(fifo_buffer_t * b, uint8_t *data, unsigned len) {
+    unsigned tail, count, i;
+
+    count = fifo_count(b);
+    if (count > len) {
+        count = len;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    tail = b->tail;
+    for (i = 0; i < count; i++) {
+        data[i] = b->buffer[(tail + i) & b->mask];
+    }
+    FIFO_BARRIER();
+    b->tail = tail + count;
+
+    return count;
+}
+
+/****************************************************************************
+* DESCRIPTION: Drops all data in the FIFO
+* RETURN:      none
+* ALGORITHM:   none
+* NOTES:       has to be called from the consumer side
+*****************************************************************************/
+void fifo_flush(fifo_buffer_t * b) {
+    if (b) {
+        b->tail = b->head;
+    }
+}
+
 /****************************************************************************
 * DESCRIPTION: Configures the ring buffer
 * RETURN:      none
@@ -132,7 +198,7 @@ void fifo_init(fifo_buffer_t * b, volatile uint8_t *buffer, unsigned buffer_len)
         b->head = 0;
         b->tail = 0;
         b->buffer = buffer;
-        b->buffer_len = buffer_len;
+        b->mask = buffer_len - 1;
     }
 
     return;
@@ -33,9 +33,12 @@
 
 /* Functional Description: Generic FIFO library for deeply
    embedded system. See the unit tests for usage examples.
-   This library only uses a byte sized chunk.
-   This library is designed for use in Interrupt Service Routines
-   and so is declared as "static inline" */
+   This library only uses a byte sized chunk, records are
+   transferred with the bulk functions.
+   Single producer, single consumer: head is only written by the
+   producer, tail only by the consumer, so one side can run in an
+   Interrupt Service Routine without locking. The length is a power
+   of two and the index is masked, no division is needed. */
 
 #ifndef FIFO_H__
 #define FIFO_H__
@@ -44,20 +47,42 @@
 #include <stdbool.h>
 
 typedef struct {
-    volatile unsigned head;      /* first byte of data */
-    volatile unsigned tail;     /* last byte of data */
+    volatile unsigned head;      /* first byte of data, producer only */
+    volatile unsigned tail;     /* last byte of data, consumer only */
     volatile uint8_t *buffer; /* block of memory or array of data */
-    unsigned buffer_len;     /* length of the data */
+    unsigned mask;           /* length of the data - 1 */
 } fifo_buffer_t;
 
+/* declares a fifo with its own storage, the length is checked at
+   compile time: FIFO_DECLARE(my_fifo, 64); */
+#define FIFO_DECLARE(_name, _len) \
+    typedef char _name ## _len_is_power_of_two[(((_len) & ((_len) - 1)) == 0) ? 1 : -1]; \
+    static volatile uint8_t _name ## _data[(_len)]; \
+    static fifo_buffer_t _name = { 0, 0, _name ## _data, (_len) - 1 }
+
+/* orders the buffer access against the index update */
+#define FIFO_BARRIER() __asm__ volatile ("dmb" ::: "memory")
+
 bool fifo_empty(fifo_buffer_t const *b);
 
+unsigned fifo_count(fifo_buffer_t const *b);
+
+unsigned fifo_space(fifo_buffer_t const *b);
+
 uint8_t fifo_peek(fifo_buffer_t const *b);
 
 uint8_t fifo_get(fifo_buffer_t * b);
 
 bool fifo_put(fifo_buffer_t * b, uint8_t data_byte);
 
+/* all or nothing, keeps records intact */
+bool fifo_put_multi(fifo_buffer_t * b, const uint8_t *data, unsigned len);
+
+/* returns the number of bytes copied, at most len */
+unsigned fifo_get_multi(fifo_buffer_t * b, uint8_t *data, unsigned len);
+
+void fifo_flush(fifo_buffer_t * b);
+
 /* note: buffer_len must be a power of two */
 void fifo_init(fifo_buffer_t * b, volatile uint8_t *buffer, unsigned buffer_len);
 
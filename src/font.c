@@ -19,9 +19,6 @@
 
 #include "font.h"
 
-// include fonts here and add an extern definition to font.h
-// DO NOT include them elsewhere
-#include "fonts/system5x7.h"
-#include "fonts/tomthumb3x5.h"
-#include "fonts/metric15x26.h"
-#include "fonts/metric7x12.h"
+// the generated font data, fonts are added in the Makefile
+// and need an extern definition in font.h. DO NOT include it elsewhere
+#include "font_compiled.h"
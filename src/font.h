@@ -22,21 +22,37 @@
 
 #include <stdint.h>
 
-// font indices
-#define FONT_LENGTH       0
-#define FONT_FIXED_WIDTH  2
-#define FONT_HEIGHT       3
-#define FONT_FIRST_CHAR   4
-#define FONT_CHAR_COUNT   5
-#define FONT_WIDTH_TABLE  6
-
-// helpers
-#define font_is_fixed_width(_f)  ((_f[FONT_LENGTH] == 0) && (_f[FONT_LENGTH+1] < 2))
-#define font_is_nopad_fixed_font(_f)  ((_f[FONT_LENGTH] == 0) && (_f[FONT_LENGTH+1] == 1))
-
-extern const uint8_t font_system5x7[];
-extern const uint8_t font_tomthumb3x5[];
-extern const uint8_t font_metric15x26[];
-extern const uint8_t font_metric7x12[];
+// compiled fonts, generated from the glcd fonts in fonts/ by
+// scripts/compile_font.py (see Makefile)
+typedef struct {
+    // height in pixels and bytes per glyph column
+    uint8_t height;
+    uint8_t pages;
+    // nominal (fixed) width
+    uint8_t width;
+    // FONT_FLAG_*
+    uint8_t flags;
+    uint8_t first_char;
+    uint8_t char_count;
+    // glyph index per char (FONT_GLYPH_NONE if not compiled in)
+    const uint8_t *glyph;
+    // per glyph width and offset into data
+    const uint8_t *glyph_width;
+    const uint16_t *glyph_offset;
+    // per glyph: one row of glyph_width bytes per page, bit 0 = top pixel
+    const uint8_t *data;
+} font_t;
+
+#define FONT_FLAG_FIXED  (1<<0)
+// no padding pixels right of and below the glyphs
+#define FONT_FLAG_NOPAD  (1<<1)
+// only some chars were compiled in, the others are drawn as a box
+#define FONT_FLAG_SUBSET (1<<2)
+#define FONT_GLYPH_NONE  0xFF
+
+extern const font_t font_system5x7;
+extern const font_t font_tomthumb3x5;
+extern const font_t font_metric15x26;
+extern const font_t font_metric7x12;
 
 #endif  // FONT_H_
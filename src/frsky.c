@@ -19,6 +19,7 @@
 
 #include "main.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include "frsky.h"
 #include "debug.h"
@@ -32,21 +33,210 @@
 #include "storage.h"
 #include "adc.h"
 #include "telemetry.h"
+#include "rftiming.h"
+#include "frsky_d16.h"
+#include "crc16.h"
+#include "mixer.h"
+#include "seqlock.h"
+#include "linkstats.h"
 
 #include <libopencm3/stm32/timer.h>
+#include <libopencm3/cm3/scb.h>
 
 // this will make binding not very reliable, use for debugging only!
 #define FRSKY_DEBUG_BIND_DATA 0
 #define FRSKY_DEBUG_HOPTABLE 1
+// print the cpu time spent in the rf isr
+#define FRSKY_DEBUG_RF_TIMING 0
+
+// the adc burst for a packet is started this long before the sending
+// slot: burst + snapshot isr + packet assembly in the bottom half
+#define FRSKY_ADC_LEAD_US (ADC_BURST_DURATION_US + 300)
+// read back and compare the cc2500 registers after loading a profile
+#define FRSKY_VERIFY_PROFILE 1
+
+// afc loop filter (all values in FSCTRL0 steps of ~1.6kHz):
+// offset += clamp(freqest * gain, +/- max_step), gain = 1/8,
+// the cc2500 is only retuned if the tracked value moved by more than the hysteresis
+#define FRSKY_AFC_SHIFT       4
+#define FRSKY_AFC_GAIN_FP     ((1 << FRSKY_AFC_SHIFT) / 8)
+#define FRSKY_AFC_MAX_STEP_FP (1 << FRSKY_AFC_SHIFT)
+#define FRSKY_AFC_HYSTERESIS_FP ((3 << FRSKY_AFC_SHIFT) / 4)
+// never pull more than this away from the stored offset
+#define FRSKY_AFC_RANGE       32
+
+// pll calibration cache: accepted temperature difference to the one stored
+// with the cache in deg C and the fscal1 difference accepted by the
+// background validation
+#define FRSKY_CALIB_CACHE_TEMP_RANGE   8
+#define FRSKY_CALIB_CACHE_TOLERANCE    1
+
+// autotune: coarse scan of the fsctrl0 range followed by a bisection of
+// both window edges. a probe listens for bind packets for at most
+// DWELL_US and is a hit once the packet scores add up to HIT_SCORE.
+// rx starts SETTLE_US after the offset change, a pause longer than
+// POLL_GAP_US between two polls (gui rendering) is not counted as dwell
+#define FRSKY_AUTOTUNE_COARSE_STEP  16
+#define FRSKY_AUTOTUNE_COARSE_COUNT 16
+#define FRSKY_AUTOTUNE_DWELL_US     40000
+#define FRSKY_AUTOTUNE_SETTLE_US    1000
+#define FRSKY_AUTOTUNE_POLL_GAP_US  2000
+#define FRSKY_AUTOTUNE_HIT_SCORE    96
+#define FRSKY_AUTOTUNE_STATE_COARSE    0
+#define FRSKY_AUTOTUNE_STATE_EDGE_LOW  1
+#define FRSKY_AUTOTUNE_STATE_EDGE_HIGH 2
+#define FRSKY_AUTOTUNE_STATE_DONE      3
 
 // DONE when n times a one:
 #define MAX_BIND_PACKET_COUNT 10
 #define HOPDATA_RECEIVE_DONE ((1  <<  (MAX_BIND_PACKET_COUNT))-1)
 
+// internal functions
+static void frsky_rx_callback(uint8_t *data, uint8_t len);
+static void frsky_queue_handle_overflows(void);
+static void frsky_marcstate_callback(uint8_t *data, uint8_t len);
+static void frsky_queue_bind_prepare(void);
+static void frsky_stx_done(uint8_t *data, uint8_t len);
+static void frsky_srx_done(uint8_t *data, uint8_t len);
+static void frsky_build_hop_images(void);
+static void frsky_build_packet(uint8_t index);
+static void frsky_build_bindpacket(volatile uint8_t *buffer, uint8_t bind_packet_id);
+static uint8_t frsky_bind_next_id(uint8_t bind_packet_id);
+static void frsky_bottom_half_trigger(void);
+static void frsky_slot_execute(uint8_t action);
+static void frsky_configure_protocol(void);
+static void frsky_freqest_callback(uint8_t *data, uint8_t len);
+static void frsky_afc_reset(void);
+static void frsky_afc_update(void);
+static void frsky_queue_afc(void);
+static void frsky_recal_callback(uint8_t *data, uint8_t len);
+static uint16_t frsky_calib_cache_key(void);
+static void frsky_calib_cache_update(void);
+static void frsky_calib_pll_cached(void);
+static void frsky_calib_cache_validate(void);
+static void frsky_autotune_probe_start(int16_t offset);
+static uint16_t frsky_autotune_packet_score(volatile uint8_t *buffer);
+static int16_t frsky_autotune_coarse_offset(uint8_t index);
+static void frsky_autotune_coarse_done(void);
+static void frsky_autotune_next(uint8_t hit);
 
 static volatile uint8_t frsky_frame_counter;
 static uint8_t frsky_last_requested_telemetry_id;
-static volatile uint32_t frsky_state;
+
+// rf slot schedules, every entry gives the action to run,
+// the time until the next slot (in us) and the next slot index.
+// a d8 TX is finished after ~7.2ms, the remaining time of one tx slot
+// per frame is used to recalibrate one hop channel (9 = 7.5 + 1.5)
+// d8 with telemetry every 4th frame: 2*9 = 18 = 7.5 + 1.3 + 9.2
+static const frsky_slot_t frsky_schedule_d8_telemetry[] = {
+    // action                  next  duration
+    { FRSKY_SLOT_TX_AFTER_RX,  1,    7500 },
+    { FRSKY_SLOT_CALIBRATE,    2,    1500 },
+    { FRSKY_SLOT_TX,           3,    9000 },
+    // hop early for the rx slot
+    { FRSKY_SLOT_TX,           4,    7500 },
+    // the next slot after the freq stabilised
+    { FRSKY_SLOT_RX_PREPARE,   5,    1300 },
+    { FRSKY_SLOT_RX,           0,    9200 },
+};
+
+// d8 without telemetry, a new packet every 9ms.
+// also used for d16 (tx takes ~4.3ms), the slot layout is the same
+static const frsky_slot_t frsky_schedule_d8_no_telemetry[] = {
+    // action                  next  duration
+    { FRSKY_SLOT_TX_CHECK,     1,    7500 },
+    { FRSKY_SLOT_CALIBRATE,    2,    1500 },
+    { FRSKY_SLOT_TX,           3,    9000 },
+    { FRSKY_SLOT_TX,           4,    9000 },
+    { FRSKY_SLOT_TX,           0,    9000 },
+};
+
+// binding: set up the bind channel once, then send bind packets every 9ms
+static const frsky_slot_t frsky_schedule_bind[] = {
+    // action                  next  duration
+    { FRSKY_SLOT_BIND_PREPARE, 1,    9000 },
+    { FRSKY_SLOT_BIND_TX,      1,    9000 },
+};
+
+// user selectable schedules, indexed by FRSKY_SCHEDULE_*
+static const frsky_schedule_t frsky_schedules[FRSKY_SCHEDULE_COUNT] = {
+    { frsky_schedule_d8_telemetry,    "D8 1:4" },
+    { frsky_schedule_d8_no_telemetry, "D8 OFF" },
+};
+
+// d8 radio configuration, loaded by frsky_configure()
+static const cc2500_profile_t frsky_profile_d8 = {
+    "D8",
+    {
+        [IOCFG2]   = 0x01,                // overwritten by cc2500_set_gdo_mode()
+        [IOCFG1]   = 0x2E,
+        [IOCFG0]   = 0x01,
+        [FIFOTHR]  = 0x07,
+        [SYNC1]    = 0xD3,
+        [SYNC0]    = 0x91,
+        [PKTLEN]   = FRSKY_PACKET_LENGTH,  // on 251x this has to be exactly our size
+        [PKTCTRL1] = CC2500_PKTCTRL1_APPEND_STATUS,  // see frsky_configure_address()
+        [PKTCTRL0] = 0x05,
+        [ADDR]     = 0x00,
+        [CHANNR]   = 0x00,
+        [FSCTRL1]  = 0x08,                // D4R-II seems to set 0x68 here ?! instead of 0x08
+        [FSCTRL0]  = 0x00,
+        [FREQ2]    = 0x5C,                // base freq 2404 mhz
+        [FREQ1]    = 0x76,
+        [FREQ0]    = 0x27,
+        [MDMCFG4]  = 0xAA,
+        [MDMCFG3]  = 0x39,
+        [MDMCFG2]  = 0x11,
+        [MDMCFG1]  = 0x23,
+        [MDMCFG0]  = 0x7A,
+        [DEVIATN]  = 0x42,
+        [MCSM2]    = 0x07,
+        [MCSM1]    = 0x0F,                // go back to rx after transmission completed
+        [MCSM0]    = 0x18,
+        [FOCCFG]   = 0x16,
+        [BSCFG]    = 0x6C,
+        [AGCCTRL2] = 0x03,
+        [AGCCTRL1] = 0x40,                // D4R uses 46 instead of 0x40
+        [AGCCTRL0] = 0x91,
+        [WOREVT1]  = 0x87,
+        [WOREVT0]  = 0x6B,
+        [WORCTRL]  = 0xF8,
+        [FREND1]   = 0x56,
+        [FREND0]   = 0x10,
+        [FSCAL3]   = 0xA9,
+        [FSCAL2]   = 0x05,
+        [FSCAL1]   = 0x00,
+        [FSCAL0]   = 0x11,
+        [RCCTRL1]  = 0x41,
+        [RCCTRL0]  = 0x00,
+        [FSTEST]   = 0x59,
+        [PTEST]    = 0x7F,
+        [AGCTEST]  = 0x3F,
+        [TEST2]    = 0x88,
+        [TEST1]    = 0x31,
+        [TEST0]    = 0x0B,
+    },
+    0xFF  // PA_TABLE0
+};
+
+// radio configuration, indexed by FRSKY_PROTOCOL_*
+static const cc2500_profile_t *const frsky_profiles[FRSKY_PROTOCOL_COUNT] = {
+    &frsky_profile_d8,
+    &frsky_d16_profile,
+};
+
+// schedule and slot executed by the rf isr
+static const frsky_slot_t *frsky_schedule;
+static volatile uint8_t frsky_slot;
+// schedule to switch to on the next slot boundary
+static const frsky_slot_t * volatile frsky_schedule_request;
+// user selected schedule (d8 only)
+static uint8_t frsky_schedule_id;
+
+// active protocol (FRSKY_PROTOCOL_*)
+static uint8_t frsky_protocol;
+// hop table increment per packet
+static uint8_t frsky_hop_step;
 
 // hop data & config
 // uint8_t storage.frsky_txid[2] = {0x16, 0x68};
@@ -63,12 +253,23 @@ static uint8_t frsky_diversity_count;
 // rssi
 static uint8_t frsky_rssi;
 static uint8_t frsky_rssi_telemetry;
+// copy of the link state for the gui
+static frsky_link_stats_t frsky_link_stats;
+static seqlock_t frsky_link_seqlock;
 static uint8_t frsky_link_quality;
 
 // pll calibration
 static uint8_t frsky_calib_fscal1_table[FRSKY_HOPTABLE_SIZE];
 static uint8_t frsky_calib_fscal2;
 static uint8_t frsky_calib_fscal3;
+static uint8_t frsky_hop_image[FRSKY_HOPTABLE_SIZE][FRSKY_HOP_IMAGE_SIZE];
+// rolling recalibration, one hop channel per FRSKY_SLOT_CALIBRATE
+static uint8_t frsky_recal_index;
+static volatile uint8_t frsky_recal_pending;
+// calibration was loaded from storage and is checked against the rolling recalibration
+static volatile uint8_t frsky_calib_cache_hit;
+static volatile uint8_t frsky_calib_cache_checked;
+static volatile uint8_t frsky_calib_cache_mismatch;
 // int16_t storage.frsky_freq_offset_acc;
 
 static uint8_t frsky_tx_enabled;
@@ -76,10 +277,36 @@ static uint8_t frsky_tx_enabled;
 // rf rxtx buffer
 static uint8_t frsky_bind_packet_received;
 static uint16_t frsky_bind_packet_hoptable_flags;
-static volatile uint8_t frsky_packet_buffer[FRSKY_PACKET_BUFFER_SIZE];
+static volatile uint8_t frsky_rx_buffer[FRSKY_PACKET_BUFFER_SIZE];
 static volatile uint8_t frsky_packet_received;
 static volatile uint8_t frsky_packet_sent;
 
+// tx packets are assembled one slot ahead by the bottom half (pendsv),
+// the rf isr only sends frsky_packet_buffer[frsky_packet_buffer_ready]
+// (sized for the larger d16 frame)
+static volatile uint8_t frsky_packet_buffer[2][FRSKY_D16_PACKET_BUFFER_SIZE];
+static volatile uint8_t frsky_packet_buffer_ready;
+// the packet for the next slot still has to be assembled, it waits for
+// an adc snapshot newer than frsky_packet_adc_sequence
+static volatile uint8_t frsky_packet_pending;
+static volatile uint32_t frsky_packet_adc_sequence;
+// adc snapshot time of the packets and of the last sent packet
+static uint32_t frsky_packet_stick_time[2];
+static volatile uint32_t frsky_stick_time_sent;
+// set by the rf isr when the telemetry slot is over
+static volatile uint8_t frsky_rx_slot_done;
+// hop index of the finished receive slot
+static volatile uint8_t frsky_rx_slot_hop;
+
+// afc: frequency offset estimate of the last received packet
+static volatile int8_t frsky_freqest;
+static volatile uint8_t frsky_freqest_valid;
+// tracked offset in FSCTRL0 steps, fixed point with FRSKY_AFC_SHIFT fractional bits
+static int16_t frsky_afc_offset_fp;
+// offset in FSCTRL0 steps, written to the cc2500 by the rf isr
+static volatile int8_t frsky_afc_offset;
+static volatile uint8_t frsky_afc_offset_changed;
+
 
 void frsky_init(void) {
     // uint8_t i;
@@ -93,9 +320,27 @@ void frsky_init(void) {
     frsky_diversity_count = 0;
     frsky_packet_received = 0;
     frsky_packet_sent = 0;
+    frsky_packet_buffer_ready = 0;
+    frsky_rx_slot_done = 0;
     frsky_bind_packet_received = 0;
 
     frsky_rssi = 100;
+    seqlock_init(&frsky_link_seqlock);
+    frsky_link_stats.rssi = 0;
+    frsky_link_stats.rssi_telemetry = 0;
+    frsky_link_stats.lost_packets = 0xFF;
+
+    frsky_schedule = frsky_schedule_d8_telemetry;
+    frsky_schedule_request = 0;
+    frsky_schedule_id = FRSKY_SCHEDULE_D8_TELEMETRY;
+    frsky_slot = 0;
+    frsky_recal_index = 0;
+
+    frsky_protocol = storage.model[storage.current_model].protocol;
+    if (frsky_protocol >= FRSKY_PROTOCOL_COUNT) {
+        frsky_protocol = FRSKY_PROTOCOL_D8;
+    }
+    frsky_hop_step = 1;
 
     // check if spi is working properly
     if (!frsky_check_transceiver()) {
@@ -117,8 +362,14 @@ void frsky_init(void) {
     // init txid matching
     frsky_configure_address();
 
-    // tune cc2500 pll and save the values to ram
-    frsky_calib_pll();
+    // protocol specific settings
+    frsky_configure_protocol();
+
+    // tune cc2500 pll (or use the cached values) and save the values to ram
+    frsky_calib_pll_cached();
+
+    // rf timing as configured for the current model
+    frsky_set_schedule(storage.model[storage.current_model].rf_schedule);
 
     // initialise 9ms timer isr
     frsky_tx_enabled = 0;
@@ -152,8 +403,17 @@ void frsky_init_timer(void) {
     // timer should count with 1MHz thus 9000 ticks = 9ms
     timer_set_period(TIM3, 9000-1);
 
+    // oc2ref goes high FRSKY_ADC_LEAD_US before a sending slot (see isr)
+    // and starts the adc burst via TRGO -> TIM15
+    timer_set_oc_mode(TIM3, TIM_OC2, TIM_OCM_PWM2);
+    timer_set_oc_value(TIM3, TIM_OC2, 0xFFFF);
+    timer_set_master_mode(TIM3, TIM_CR2_MMS_COMPARE_OC2REF);
+
     // DO NOT ENABLE INT yet!
 
+    // bottom half, runs below everything else
+    nvic_set_priority(NVIC_PENDSV_IRQ, NVIC_PRIO_FRSKY_BOTTOM_HALF);
+
     // enable timer
     timer_enable_counter(TIM3);
 }
@@ -162,90 +422,255 @@ void frsky_tx_set_enabled(uint32_t enabled) {
     // TIM Interrupts enable? -> tx active
     if (enabled) {
         frsky_frame_counter = 0;
-        frsky_state = 0;
+        frsky_slot = 0;
+        frsky_rx_slot_done = 0;
+        frsky_recal_pending = 0;
+        frsky_afc_reset();
+        frsky_packet_pending = 0;
+        // the first packet has to be ready before the isr starts
+        frsky_build_packet(frsky_packet_buffer_ready);
+        // sample the sticks right before they are needed
+        adc_set_frame_sync(frsky_bottom_half_trigger);
+        // telemetry packets are fetched by the gdo irq
+        cc2500_rx_interrupt_enable(FRSKY_PACKET_BUFFER_SIZE, frsky_rx_callback);
         // enable ISR
         timer_enable_irq(TIM3, TIM_DIER_UIE);
     } else {
         // stop ISR
         timer_disable_irq(TIM3, TIM_DIER_UIE);
+        adc_set_frame_sync(0);
+        cc2500_rx_interrupt_disable();
         // make sure last packet was sent
         delay_ms(20);
+        // all queued transfers have to be finished before
+        // any blocking access to the cc2500 is allowed again
+        while (!cc2500_queue_idle()) {}
     }
 }
 
 static void frsky_send_packet(void) {
+    volatile uint8_t *buffer = frsky_packet_buffer[frsky_packet_buffer_ready];
+
     // Stop RX DMA
-    cc2500_strobe(RFST_SFRX);
+    cc2500_queue_strobe(RFST_SFRX);
 
     // enable tx
-    cc2500_enter_txmode();
+    cc2500_queue_enter_txmode();
+
+    // the frame counter is only known now
+    if (frsky_protocol == FRSKY_PROTOCOL_D8) {
+        buffer[3] = frsky_frame_counter;
+    }
+
+    // send packet
+    frsky_stick_time_sent = frsky_packet_stick_time[frsky_packet_buffer_ready];
+    cc2500_queue_transmit_packet(buffer, buffer[0] + 1);
+    cc2500_queue_call(frsky_stx_done);
+}
+
+// executed from the cc2500 queue right after the strobe went out
+static void frsky_stx_done(uint8_t *UNUSED(data), uint8_t UNUSED(len)) {
+    rftiming_strobe(RFTIMING_STROBE_STX);
+    if (frsky_stick_time_sent) {
+        rftiming_stick_age(rftiming_now() - frsky_stick_time_sent);
+    }
+}
+
+static void frsky_srx_done(uint8_t *UNUSED(data), uint8_t UNUSED(len)) {
+    rftiming_strobe(RFTIMING_STROBE_SRX);
+}
 
-    // fetch adc channel data
-    adc_process();
-    uint16_t adc_data[8];
-    uint32_t i;
-    for (i = 0; i < 8; i++) {
-        adc_data[i] = adc_get_channel_packetdata(i);
+static void frsky_build_packet(uint8_t index) {
+    volatile uint8_t *buffer = frsky_packet_buffer[index];
+
+    // fetch adc channel data, all channels from the same adc cycle,
+    // and run the model mixer on it
+    adc_snapshot_t snapshot;
+    adc_get_snapshot(&snapshot);
+    uint16_t adc_data[CHANNEL_ID_SIZE];
+    mixer_process(snapshot.rescaled, snapshot.switches, adc_data);
+    frsky_packet_stick_time[index] = snapshot.timestamp;
+
+    if (frsky_protocol == FRSKY_PROTOCOL_D16) {
+        // this packet is sent after the next hop
+        uint8_t hop_index = (frsky_current_ch_idx + frsky_hop_step) % FRSKY_HOPTABLE_SIZE;
+        frsky_d16_build_packet(buffer, hop_index, adc_data);
+        return;
     }
 
     // build frsky packet
     // packet length
-    frsky_packet_buffer[0] = 0x11;
+    buffer[0] = 0x11;
     // txid
-    frsky_packet_buffer[1] = storage.frsky_txid[0];
-    frsky_packet_buffer[2] = storage.frsky_txid[1];
-    // frame counter
-    frsky_packet_buffer[3] = frsky_frame_counter;
+    buffer[1] = storage.frsky_txid[0];
+    buffer[2] = storage.frsky_txid[1];
+    // frame counter, filled in by frsky_send_packet()
+    buffer[3] = 0;
     // last received telemetry frame
-    frsky_packet_buffer[4] = frsky_last_requested_telemetry_id;
+    buffer[4] = frsky_last_requested_telemetry_id;
     // my tgy 9x sends 0x0B (is this how many bytes are free in hub buf?)
-    frsky_packet_buffer[5] = 0x0B;
+    buffer[5] = 0x0B;
     // 6 .. 9 is LO(channel data 0..3)
-    frsky_packet_buffer[6] = adc_data[0] & 0xFF;
-    frsky_packet_buffer[7] = adc_data[1] & 0xFF;
-    frsky_packet_buffer[8] = adc_data[2] & 0xFF;
-    frsky_packet_buffer[9] = adc_data[3] & 0xFF;
+    buffer[6] = adc_data[0] & 0xFF;
+    buffer[7] = adc_data[1] & 0xFF;
+    buffer[8] = adc_data[2] & 0xFF;
+    buffer[9] = adc_data[3] & 0xFF;
     // 10 .. 11 is HI(channel data 0..3)
-    frsky_packet_buffer[10] = ((adc_data[0]>>8) & 0x0F) | ((adc_data[1]>>4) & 0xF0);
-    frsky_packet_buffer[11] = ((adc_data[2]>>8) & 0x0F) | ((adc_data[3]>>4) & 0xF0);
+    buffer[10] = ((adc_data[0]>>8) & 0x0F) | ((adc_data[1]>>4) & 0xF0);
+    buffer[11] = ((adc_data[2]>>8) & 0x0F) | ((adc_data[3]>>4) & 0xF0);
     // 12 .. 15 is LO(channel data 4..7)
-    frsky_packet_buffer[12] = adc_data[4] & 0xFF;
-    frsky_packet_buffer[13] = adc_data[5] & 0xFF;
-    frsky_packet_buffer[14] = adc_data[6] & 0xFF;
-    frsky_packet_buffer[15] = adc_data[7] & 0xFF;
+    buffer[12] = adc_data[4] & 0xFF;
+    buffer[13] = adc_data[5] & 0xFF;
+    buffer[14] = adc_data[6] & 0xFF;
+    buffer[15] = adc_data[7] & 0xFF;
     // 16 .. 17 is HI(channel data 4..7)
-    frsky_packet_buffer[16] = ((adc_data[4]>>8) & 0x0F) | ((adc_data[5]>>4) & 0xF0);
-    frsky_packet_buffer[17] = ((adc_data[6]>>8) & 0x0F) | ((adc_data[7]>>4) & 0xF0);
-
-    // send packet
-    cc2500_transmit_packet(frsky_packet_buffer, frsky_packet_buffer[0] + 1);
+    buffer[16] = ((adc_data[4]>>8) & 0x0F) | ((adc_data[5]>>4) & 0xF0);
+    buffer[17] = ((adc_data[6]>>8) & 0x0F) | ((adc_data[7]>>4) & 0xF0);
 }
 
 static uint8_t frsky_packet_lost_counter;
 
+// executed from the cc2500 queue once the gdo irq fetched a packet
+static void frsky_rx_callback(uint8_t *data, uint8_t len) {
+    uint8_t i;
+
+    // last packet not yet processed by the bottom half?
+    if (frsky_packet_received) return;
+
+    for (i = 0; i < len; i++) {
+        frsky_rx_buffer[i] = data[i];
+    }
+    frsky_packet_received = 1;
+
+    // fetch the frequency offset estimate for this packet
+    frsky_freqest_valid = 0;
+    cc2500_queue_register_read(FREQEST, 1, frsky_freqest_callback);
+}
+
+static void frsky_freqest_callback(uint8_t *data, uint8_t UNUSED(len)) {
+    frsky_freqest = (int8_t)data[0];
+    frsky_freqest_valid = 1;
+}
+
+static void frsky_afc_reset(void) {
+    frsky_afc_offset = storage.frsky_freq_offset;
+    frsky_afc_offset_fp = ((int16_t)storage.frsky_freq_offset) << FRSKY_AFC_SHIFT;
+    frsky_afc_offset_changed = 0;
+    frsky_freqest_valid = 0;
+}
+
+// runs in the bottom half after a valid packet
+static void frsky_afc_update(void) {
+    if (!frsky_freqest_valid) {
+        return;
+    }
+    frsky_freqest_valid = 0;
+
+    // loop filter with bounded step
+    int16_t step = frsky_freqest * FRSKY_AFC_GAIN_FP;
+    step = max(step, -FRSKY_AFC_MAX_STEP_FP);
+    step = min(step, FRSKY_AFC_MAX_STEP_FP);
+    frsky_afc_offset_fp += step;
+
+    // stay close to the calibrated offset
+    int16_t limit = ((int16_t)storage.frsky_freq_offset) << FRSKY_AFC_SHIFT;
+    frsky_afc_offset_fp = max(frsky_afc_offset_fp, limit - (FRSKY_AFC_RANGE << FRSKY_AFC_SHIFT));
+    frsky_afc_offset_fp = min(frsky_afc_offset_fp, limit + (FRSKY_AFC_RANGE << FRSKY_AFC_SHIFT));
+
+    // hysteresis, only retune on a significant change
+    int16_t applied_fp = ((int16_t)frsky_afc_offset) << FRSKY_AFC_SHIFT;
+    if (abs(frsky_afc_offset_fp - applied_fp) > FRSKY_AFC_HYSTERESIS_FP) {
+        // round to nearest
+        frsky_afc_offset = (frsky_afc_offset_fp + (1 << (FRSKY_AFC_SHIFT - 1))) >> FRSKY_AFC_SHIFT;
+        frsky_afc_offset_changed = 1;
+    }
+}
+
+// runs in the rf isr, right after the hop (cc2500 is idle)
+static void frsky_queue_afc(void) {
+    if (frsky_afc_offset_changed) {
+        frsky_afc_offset_changed = 0;
+        cc2500_queue_set_register(FSCTRL0, frsky_afc_offset);
+    }
+}
+
+// executed from the cc2500 queue with the fresh FSCAL3, FSCAL2 and FSCAL1 values
+static void frsky_recal_callback(uint8_t *data, uint8_t UNUSED(len)) {
+    uint8_t i = frsky_recal_index;
+    uint8_t j;
+
+    frsky_calib_fscal1_table[i] = data[2];
+    // single byte store, the hop image is never seen half updated
+    frsky_hop_image[i][FRSKY_HOP_IMAGE_FSCAL1] = data[2];
+
+    // compare against the cached value once
+    if (frsky_calib_cache_hit && (frsky_calib_cache_checked < FRSKY_HOPTABLE_SIZE)) {
+        if (abs((int16_t)data[2] - (int16_t)storage.frsky_calib_fscal1[i]) > FRSKY_CALIB_CACHE_TOLERANCE) {
+            frsky_calib_cache_mismatch++;
+        }
+        frsky_calib_cache_checked++;
+    }
+
+    // frsky_calib_pll() takes fscal2 and fscal3 from the last hop channel, do the same here
+    if (i == (FRSKY_HOPTABLE_SIZE - 1)) {
+        if ((data[0] != frsky_calib_fscal3) || (data[1] != frsky_calib_fscal2)) {
+            frsky_calib_fscal3 = data[0];
+            frsky_calib_fscal2 = data[1];
+            for (j = 0; j < FRSKY_HOPTABLE_SIZE; j++) {
+                frsky_hop_image[j][FRSKY_HOP_IMAGE_FSCAL3] = data[0];
+                frsky_hop_image[j][FRSKY_HOP_IMAGE_FSCAL2] = data[1];
+            }
+        }
+        if (frsky_calib_cache_hit &&
+            ((data[0] != storage.frsky_calib_fscal3) || (data[1] != storage.frsky_calib_fscal2))) {
+            frsky_calib_cache_mismatch++;
+        }
+    }
+
+    frsky_recal_index = (i + 1) % FRSKY_HOPTABLE_SIZE;
+}
+
+int8_t frsky_get_afc_offset(void) {
+    return frsky_afc_offset;
+}
+
+// runs in the bottom half
 static void frsky_receive_packet(void) {
-    // fetch incoming packet
-    cc2500_process_packet(&frsky_packet_received, (volatile uint8_t *)&frsky_packet_buffer, \
-                      FRSKY_PACKET_BUFFER_SIZE);
+    // incoming packet was already fetched in the background
 
     // increment counter, will be cleared on valid packet rx
     frsky_packet_lost_counter++;
 
+    // per hop statistics of this receive slot
+    if (frsky_packet_received && FRSKY_VALID_PACKET(frsky_rx_buffer)) {
+        linkstats_rx(frsky_rx_slot_hop, 1,
+                     frsky_extract_rssi(frsky_rx_buffer[FRSKY_PACKET_BUFFER_SIZE - 2]),
+                     frsky_rx_buffer[FRSKY_PACKET_BUFFER_SIZE - 1] & 0x7F);
+    } else {
+        linkstats_rx(frsky_rx_slot_hop, 0, 0, 0);
+    }
+
     // packet received?
     if (frsky_packet_received) {
         // decrypt data
-        if (FRSKY_VALID_PACKET(frsky_packet_buffer)) {
+        if (FRSKY_VALID_PACKET(frsky_rx_buffer)) {
             // reset lost packet counter
             frsky_packet_lost_counter = 0;
 
+            // track the frequency offset
+            frsky_afc_update();
+
             // extract RSSI
-            frsky_rssi = frsky_rssi + (8 * ((uint32_t)frsky_packet_buffer[5] -
+            frsky_rssi = frsky_rssi + (8 * ((uint32_t)frsky_rx_buffer[5] -
                                        (uint32_t)frsky_rssi)) / 128;
-            // frsky_rssi           = (((uint32_t)frsky_packet_buffer[5])*10 - 310)*12987/10000;
+            // frsky_rssi           = (((uint32_t)frsky_rx_buffer[5])*10 - 310)*12987/10000;
             frsky_rssi_telemetry = frsky_rssi_telemetry + (8 * (
-                                        (uint32_t)frsky_extract_rssi(frsky_packet_buffer[18]) -
+                                        (uint32_t)frsky_extract_rssi(frsky_rx_buffer[18]) -
                                         (uint32_t)frsky_rssi_telemetry)) / 128;
 
+            // analog inputs and rssi of the receiver
+            telemetry_set_link(frsky_rx_buffer[3], frsky_rx_buffer[4], frsky_rx_buffer[5]);
+
             // extract telemetry packets:
             // buffer[0]  = bytes used
             // buffer[1]  = last received telemetry id
@@ -259,191 +684,387 @@ static void frsky_receive_packet(void) {
             // * not all 10 bytes has to be filled in, only the number of bytes that were received
             //   will be sent in one frame
             //
-            uint8_t telemetry_frame_id = frsky_packet_buffer[7];
+            uint8_t telemetry_frame_id = frsky_rx_buffer[7];
             if (telemetry_frame_id == frsky_last_requested_telemetry_id) {
                 // request new data with next packet
                 frsky_last_requested_telemetry_id = (frsky_last_requested_telemetry_id + 1) & 0x1F;
 
                 // extract data
-                uint8_t bytecount = min(frsky_packet_buffer[6], 10);
-                uint8_t i;
-                for (i = 0; i < bytecount; i++) {
-                    telemetry_enqueue(frsky_packet_buffer[8 + i]);
-                }
+                uint8_t bytecount = min(frsky_rx_buffer[6], 10);
+                telemetry_enqueue((const uint8_t *)&frsky_rx_buffer[8], bytecount);
             }
 
             /*debug_flush();
             uint32_t i;
             for (i = 0; i < FRSKY_PACKET_BUFFER_SIZE; i++) {
-                debug_put_hex8(frsky_packet_buffer[i]);
+                debug_put_hex8(frsky_rx_buffer[i]);
                 debug_putc(' ');
             }
             debug_put_newline();*/
         }
-    }
-
 
+        // processed
+        frsky_packet_received = 0;
+    }
 
-    // handle any ovf conditions
-    frsky_handle_overflows();
+    // publish a consistent set for the gui
+    seqlock_write_begin(&frsky_link_seqlock);
+    frsky_link_stats.rssi           = frsky_rssi;
+    frsky_link_stats.rssi_telemetry = frsky_rssi_telemetry;
+    frsky_link_stats.lost_packets   = frsky_packet_lost_counter;
+    seqlock_write_end(&frsky_link_seqlock);
 }
 
 void frsky_handle_telemetry(void) {
     // handle incoming telemetry data
     telemetry_process();
+
+    // background check of the cached pll calibration
+    frsky_calib_cache_validate();
+
+#if FRSKY_DEBUG_RF_TIMING
+    static uint8_t frsky_rf_timing_print;
+    if ((frsky_frame_counter & 0x80) != frsky_rf_timing_print) {
+        // roughly once per second
+        frsky_rf_timing_print = frsky_frame_counter & 0x80;
+        rftiming_dump();
+    }
+#endif  // FRSKY_DEBUG_RF_TIMING
 }
 
+// must not be called from the rf isrs
+void frsky_get_link_stats(frsky_link_stats_t *stats) {
+    uint32_t sequence;
+
+    do {
+        sequence = seqlock_read_begin(&frsky_link_seqlock);
+        *stats = frsky_link_stats;
+    } while (seqlock_read_retry(&frsky_link_seqlock, sequence));
+}
 
 void frsky_get_rssi(uint8_t *rssi, uint8_t *rssi_telemetry) {
-    if (frsky_packet_lost_counter > 20) {
+    frsky_link_stats_t stats;
+
+    frsky_get_link_stats(&stats);
+    if (stats.lost_packets > 20) {
         *rssi           = 0;
         *rssi_telemetry = 0;
     } else {
-        *rssi           = frsky_rssi;
-        *rssi_telemetry = frsky_rssi_telemetry;
+        *rssi           = stats.rssi;
+        *rssi_telemetry = stats.rssi_telemetry;
     }
 }
 
 void TIM3_IRQHandler(void) {
+    // NOTE: everything in here is queued to the cc2500, no busy waiting allowed
+    rftiming_slot_enter(frsky_slot, timer_get_counter(TIM3));
+
     if (timer_get_flag(TIM3, TIM_SR_UIF)) {
         // clear flag (NOTE: this should never be done at the end of the ISR)
         timer_clear_flag(TIM3, TIM_SR_UIF);
 
-        // when will there be the next isr?
-        switch (frsky_state) {
-            default:
-            case (0) :
-                // process any incoming telemetry data
-                frsky_receive_packet();
-                // hop to next channel
-                frsky_increment_channel(1);
-                // send data
-                frsky_send_packet();
-                frsky_frame_counter++;
-                // next hop in 9ms
-                timer_set_period(TIM3, 9000-1);
-                frsky_state = 1;
-                break;
-
-            case (1) :
-                // hop to next channel
-                frsky_increment_channel(1);
-                // send data
-                frsky_send_packet();
-                frsky_frame_counter++;
-                // next hop in 9ms
-                timer_set_period(TIM3, 9000-1);
-                frsky_state = 2;
-                break;
-
-            case (2) :
-                // hop to next channel
-                frsky_increment_channel(1);
-                // send data
-                frsky_send_packet();
-                frsky_frame_counter++;
-                // after this tx we expect rx data,
-                // TX is finished after ~7.2ms -> next isr in 7.5ms
-                timer_set_period(TIM3, 7500-1);
-                frsky_state = 3;
-                break;
-
-            case (3) :
-                // prepare for data receiption, hop to next channel
-                frsky_increment_channel(1);
-                // enable LNA
-                cc2500_enter_rxmode();
-                // the next hop will now in 1.3ms (after freq stabilised)
-                timer_set_period(TIM3, 1300-1-0*200);
-                frsky_state = 4;
-                break;
-
-            case (4) :
-                // now go to RX mode
-                // go to idle
-                cc2500_strobe(RFST_SRX);
-                // increment framecounter
-                frsky_frame_counter++;
-                // the next hop will now in 9.2ms
-                // 2*9 = 18 = 7.5 + 1.3 + 9.2
-                timer_set_period(TIM3, 9200-1+0*200);
-                frsky_state = 0;
-                break;
-
-            case (0x80) :
-                // bind mode, set timeout to 9ms
-                timer_set_period(TIM3, 9000);
-
-                // get bind packet index
-                frsky_frame_counter++;
-                if ((frsky_frame_counter * 5) > FRSKY_HOPTABLE_SIZE) {
-                    frsky_frame_counter = 0;
-                }
+        // schedule changes are applied on a slot boundary only
+        if (frsky_schedule_request != 0) {
+            frsky_schedule = frsky_schedule_request;
+            frsky_schedule_request = 0;
+            frsky_slot = 0;
+            frsky_frame_counter = 0;
+        }
 
-                // send bind packet
-                frsky_send_bindpacket(frsky_frame_counter);
-                frsky_state = 0x80;
-                break;
+        // a calibration started in the last slot is done by now
+        if (frsky_recal_pending) {
+            frsky_recal_pending = 0;
+            // FSCAL3, FSCAL2 and FSCAL1 are consecutive registers
+            cc2500_queue_register_read(FSCAL3 | BURST_FLAG, 3, frsky_recal_callback);
         }
+
+        const frsky_slot_t *slot = &frsky_schedule[frsky_slot];
+
+        // run this slot
+        frsky_slot_execute(slot->action);
+
+        // when will there be the next isr?
+        timer_set_period(TIM3, slot->duration - 1);
+        frsky_slot = slot->next;
+
+        // the packet for the next slot is assembled once the adc burst,
+        // started by oc2 FRSKY_ADC_LEAD_US before the slot ends, is done
+        frsky_packet_adc_sequence = adc_get_snapshot_sequence();
+        frsky_packet_pending = FRSKY_SLOT_SENDS(frsky_schedule[frsky_slot].action);
+        if (frsky_packet_pending) {
+            timer_set_oc_value(TIM3, TIM_OC2, slot->duration - FRSKY_ADC_LEAD_US);
+        } else {
+            timer_set_oc_value(TIM3, TIM_OC2, 0xFFFF);
+        }
+
+        // prepare the next slot
+        frsky_bottom_half_trigger();
     }
+
+    rftiming_slot_exit();
 }
 
+static void frsky_slot_execute(uint8_t action) {
+    switch (action) {
+        case (FRSKY_SLOT_TX_AFTER_RX) :
+            // telemetry slot is over, the bottom half processes any data
+            frsky_rx_slot_hop  = frsky_current_ch_idx;
+            frsky_rx_slot_done = 1;
+            // fall through
+        case (FRSKY_SLOT_TX_CHECK) :
+            // handle any ovf conditions
+            frsky_queue_handle_overflows();
+            // fall through
+        default:
+        case (FRSKY_SLOT_TX) :
+            // hop to next channel
+            frsky_increment_channel(frsky_hop_step);
+            // apply any frequency correction
+            frsky_queue_afc();
+            // send data
+            frsky_send_packet();
+            frsky_frame_counter++;
+            break;
 
-void frsky_send_bindpacket(uint8_t bind_packet_id) {
-    uint8_t i;
+        case (FRSKY_SLOT_RX_PREPARE) :
+            // prepare for data receiption, hop to next channel
+            frsky_increment_channel(frsky_hop_step);
+            // enable LNA
+            cc2500_queue_enter_rxmode();
+            break;
 
-    // Stop RX DMA
-    cc2500_strobe(RFST_SFRX);
+        case (FRSKY_SLOT_RX) :
+            // now go to RX mode
+            // drop anything received before, then go to rx
+            frsky_packet_received = 0;
+            cc2500_queue_strobe(RFST_SRX);
+            cc2500_queue_call(frsky_srx_done);
+            // increment framecounter
+            frsky_frame_counter++;
+            break;
+
+        case (FRSKY_SLOT_CALIBRATE) :
+            // tx is done, recalibrate the pll for the next hop channel,
+            // the result is fetched at the start of the next slot
+            cc2500_queue_strobe(RFST_SIDLE);
+            cc2500_queue_set_register(CHANNR, storage.frsky_hop_table[frsky_recal_index]);
+            cc2500_queue_strobe(RFST_SCAL);
+            frsky_recal_pending = 1;
+            break;
+
+        case (FRSKY_SLOT_BIND_PREPARE) :
+            // enter bind mode, set up address and calibrate channel 0
+            frsky_frame_counter = 0;
+            frsky_queue_bind_prepare();
+            break;
+
+        case (FRSKY_SLOT_BIND_TX) :
+            // get bind packet index
+            frsky_frame_counter = frsky_bind_next_id(frsky_frame_counter);
+            // send bind packet
+            frsky_send_bindpacket();
+            break;
+    }
+}
+
+void frsky_set_schedule(uint8_t schedule_id) {
+    if (schedule_id >= FRSKY_SCHEDULE_COUNT) {
+        schedule_id = FRSKY_SCHEDULE_D8_TELEMETRY;
+    }
+    frsky_schedule_id = schedule_id;
+
+    if (frsky_protocol == FRSKY_PROTOCOL_D16) {
+        // d16 has a fixed schedule, same slots as d8 without telemetry
+        debug("frsky: schedule D16\n"); debug_flush();
+        frsky_schedule_request = frsky_schedule_d8_no_telemetry;
+        return;
+    }
+
+    debug("frsky: schedule ");
+    debug(frsky_schedules[schedule_id].name);
+    debug_put_newline();
+    debug_flush();
+
+    // the rf isr picks this up on the next slot boundary
+    frsky_schedule_request = frsky_schedules[schedule_id].slots;
+}
+
+// reconfigures the cc2500, blocks for the duration of the pll calibration
+void frsky_set_protocol(uint8_t protocol) {
+    if (protocol >= FRSKY_PROTOCOL_COUNT) {
+        protocol = FRSKY_PROTOCOL_D8;
+    }
+    if (protocol == frsky_protocol) {
+        return;
+    }
+
+    debug("frsky: protocol ");
+    debug(frsky_get_protocol_name(protocol));
+    debug_put_newline();
+    debug_flush();
+
+    frsky_tx_set_enabled(0);
 
+    frsky_protocol = protocol;
+    frsky_configure();
+    frsky_configure_address();
+    frsky_configure_protocol();
+    frsky_calib_pll_cached();
+
+    // the schedule depends on the protocol
+    frsky_set_schedule(frsky_schedule_id);
+
+    frsky_tx_set_enabled(1);
+}
+
+char *frsky_get_protocol_name(uint8_t protocol) {
+    switch (protocol) {
+        case (FRSKY_PROTOCOL_D8)  : return "D8";
+        case (FRSKY_PROTOCOL_D16) : return "D16";
+        default                   : return "?";
+    }
+}
+
+static void frsky_configure_protocol(void) {
+    if (frsky_protocol == FRSKY_PROTOCOL_D16) {
+        frsky_d16_init();
+        frsky_hop_step = frsky_d16_get_chanskip();
+    } else {
+        // d8 hops through the table in order
+        frsky_hop_step = 1;
+    }
+}
+
+char *frsky_get_schedule_name(uint8_t schedule_id) {
+    if (schedule_id >= FRSKY_SCHEDULE_COUNT) {
+        return "?";
+    }
+    return frsky_schedules[schedule_id].name;
+}
+
+static void frsky_bottom_half_trigger(void) {
+    SCB_ICSR = SCB_ICSR_PENDSVSET;
+}
+
+// bottom half of the rf isr, triggered after every slot.
+// everything that is not timing critical is done here:
+// telemetry extraction and assembly of the packet for the next slot
+void pend_sv_handler(void) {
+    uint8_t next = frsky_packet_buffer_ready ^ 1;
+
+    // process any incoming telemetry data
+    if (frsky_rx_slot_done) {
+        frsky_rx_slot_done = 0;
+        frsky_receive_packet();
+    }
+
+    // build the packet for the next slot in the unused buffer,
+    // only if that slot sends (d16 alternates channel groups per packet)
+    if (!frsky_packet_pending) {
+        return;
+    }
+
+    if (frsky_schedule == frsky_schedule_bind) {
+        frsky_packet_pending = 0;
+        frsky_packet_stick_time[next] = 0;
+        if (frsky_protocol == FRSKY_PROTOCOL_D16) {
+            frsky_d16_build_bindpacket(frsky_packet_buffer[next], frsky_bind_next_id(frsky_frame_counter));
+        } else {
+            frsky_build_bindpacket(frsky_packet_buffer[next], frsky_bind_next_id(frsky_frame_counter));
+        }
+    } else {
+        // wait for the fresh adc snapshot, the adc isr triggers us again
+        if (adc_get_snapshot_sequence() == frsky_packet_adc_sequence) {
+            return;
+        }
+        frsky_packet_pending = 0;
+        frsky_build_packet(next);
+    }
+
+    // and hand it over to the rf isr
+    frsky_packet_buffer_ready = next;
+}
+
+static void frsky_queue_bind_prepare(void) {
     // frequency offset to zero(will do auto tune later on)
     storage.frsky_freq_offset = 0;
 
-    // init txid matching
-    frsky_configure_address();
+    // same as frsky_configure_address()
+    cc2500_queue_strobe(RFST_SIDLE);
+    cc2500_queue_set_register(FSCTRL0, storage.frsky_freq_offset);
+    cc2500_queue_set_register(MCSM0, 0x08);
+    cc2500_queue_set_register(ADDR, storage.frsky_txid[0]);
+    cc2500_queue_set_register(PKTCTRL1, CC2500_PKTCTRL1_APPEND_STATUS | CC2500_PKTCTRL1_CRC_AUTOFLUSH | \
+                              CC2500_PKTCTRL1_FLAG_ADR_CHECK_01);
+
+    // set channel 0 and calibrate, takes ~800us and
+    // is done long before the first bind packet is sent
+    cc2500_queue_set_register(CHANNR, 0);
+    cc2500_queue_strobe(RFST_SCAL);
+}
+
+
+static uint8_t frsky_bind_next_id(uint8_t bind_packet_id) {
+    bind_packet_id++;
+    if ((bind_packet_id * 5) > FRSKY_HOPTABLE_SIZE) {
+        bind_packet_id = 0;
+    }
+    return bind_packet_id;
+}
+
+void frsky_send_bindpacket(void) {
+    volatile uint8_t *buffer = frsky_packet_buffer[frsky_packet_buffer_ready];
 
-    // set channel 0
-    frsky_tune_channel(0);
+    // Stop RX DMA
+    cc2500_queue_strobe(RFST_SFRX);
+
+    // address and channel 0 were set up by frsky_queue_bind_prepare()
 
     // enable tx
-    cc2500_enter_txmode();
+    cc2500_queue_enter_txmode();
+
+    // send packet
+    cc2500_queue_transmit_packet(buffer, buffer[0] + 1);
+    cc2500_queue_call(frsky_stx_done);
+}
+
+static void frsky_build_bindpacket(volatile uint8_t *buffer, uint8_t bind_packet_id) {
+    uint8_t i;
 
     // length of byte(always 0x11 = 17 bytes)
-    frsky_packet_buffer[0] = 0x11;
+    buffer[0] = 0x11;
     // bind identifier?
-    frsky_packet_buffer[1] = 0x03;
-    frsky_packet_buffer[2] = 0x01;
+    buffer[1] = 0x03;
+    buffer[2] = 0x01;
     // txid
-    frsky_packet_buffer[3] = storage.frsky_txid[0];
-    frsky_packet_buffer[4] = storage.frsky_txid[1];
+    buffer[3] = storage.frsky_txid[0];
+    buffer[4] = storage.frsky_txid[1];
     // hoptable index
-    frsky_packet_buffer[5] = bind_packet_id * 5;
+    buffer[5] = bind_packet_id * 5;
 
     // add a maximum of 5 bytes hoptable data
     for (i = 0; i < 5; i++) {
         uint8_t index = bind_packet_id * 5 + i;
         if (index < FRSKY_HOPTABLE_SIZE) {
-            frsky_packet_buffer[6 + i] = storage.frsky_hop_table[index];
+            buffer[6 + i] = storage.frsky_hop_table[index];
         } else {
-            frsky_packet_buffer[6 + i] = 0;
+            buffer[6 + i] = 0;
         }
     }
 
     // fill with zeros
     for (i = 11; i < 17; i++) {
-        frsky_packet_buffer[i] = 0;
+        buffer[i] = 0;
     }
 
     debug("frsky: BIND");
-    debug_put_hex8(frsky_packet_buffer[5]);
+    debug_put_hex8(buffer[5]);
     debug_putc(' ');
     for (i=0; i < 5; i++) {
-        debug_put_hex8(frsky_packet_buffer[6 + i]);
+        debug_put_hex8(buffer[6 + i]);
         debug_putc(' ');
     }
-    debug("\n"); debug_flush();
-
-    // send packet
-    cc2500_transmit_packet(frsky_packet_buffer, frsky_packet_buffer[0] + 1);
+    debug("\n");
 }
 
 
@@ -479,50 +1100,19 @@ uint8_t frsky_check_transceiver(void) {
 void frsky_configure(void) {
     debug("frsky: configure\n"); debug_flush();
 
-    // start idle
-    cc2500_strobe(RFST_SIDLE);
+    // all modem settings for the current protocol in one burst
+    cc2500_load_profile(frsky_profiles[frsky_protocol]);
+
+    #if FRSKY_VERIFY_PROFILE
+    if (cc2500_verify_profile(frsky_profiles[frsky_protocol])) {
+        debug("frsky: profile verify FAILED\n");
+        debug_flush();
+    }
+    #endif  // FRSKY_VERIFY_PROFILE
 
     // IOCFG0,1,2 is set in hal code(it is specific to the board used)
     cc2500_set_gdo_mode();
 
-    // normal config
-    cc2500_set_register(MCSM1    , 0x0F);  // go back to rx after transmission completed
-    cc2500_set_register(MCSM0    , 0x18);
-    cc2500_set_register(PKTLEN   , FRSKY_PACKET_LENGTH);  // on 251x this has to be exactly our size
-    cc2500_set_register(PKTCTRL0 , 0x05);
-    cc2500_set_register(PA_TABLE0, 0xFF);
-    cc2500_set_register(FSCTRL1  , 0x08);  // D4R-II seems to set 0x68 here ?! instead of 0x08
-    cc2500_set_register(FSCTRL0  , 0x00);
-    // set base freq 2404 mhz
-    cc2500_set_register(FREQ2    , 0x5C);
-    cc2500_set_register(FREQ1    , 0x76);
-    cc2500_set_register(FREQ0    , 0x27);
-    cc2500_set_register(MDMCFG4  , 0xAA);
-    cc2500_set_register(MDMCFG3  , 0x39);
-    cc2500_set_register(MDMCFG2  , 0x11);
-    cc2500_set_register(MDMCFG1  , 0x23);
-    cc2500_set_register(MDMCFG0  , 0x7A);
-    cc2500_set_register(DEVIATN  , 0x42);
-    cc2500_set_register(FOCCFG   , 0x16);
-    cc2500_set_register(BSCFG    , 0x6C);
-    cc2500_set_register(AGCCTRL2 , 0x03);
-    cc2500_set_register(AGCCTRL1 , 0x40);  // D4R uses 46 instead of 0x40);
-    cc2500_set_register(AGCCTRL0 , 0x91);
-    cc2500_set_register(FREND1   , 0x56);
-    cc2500_set_register(FREND0   , 0x10);
-    cc2500_set_register(FSCAL3   , 0xA9);
-    cc2500_set_register(FSCAL2   , 0x05);
-    cc2500_set_register(FSCAL1   , 0x00);
-    cc2500_set_register(FSCAL0   , 0x11);
-    // ???FSTEST   , 0x59);
-    cc2500_set_register(TEST2    , 0x88);
-    cc2500_set_register(TEST1    , 0x31);
-    cc2500_set_register(TEST0    , 0x0B);
-    // cc2500_set_register(FIFOTHR  , 0x0F);  // fifo threshold -> tx gdo goes high if 1 byte left
-    cc2500_set_register(ADDR     , 0x00);
-
-    // for now just append status
-    cc2500_set_register(PKTCTRL1, CC2500_PKTCTRL1_APPEND_STATUS);
     debug("frsky: configure done\n"); debug_flush();
 }
 
@@ -557,7 +1147,7 @@ void frsky_do_clone_prepare(void) {
 void frsky_enter_bindmode(void) {
     debug("frsky: do bind\n"); debug_flush();
 
-    frsky_state = 0x80;
+    frsky_schedule_request = frsky_schedule_bind;
 
     // set up leds:
     led_button_r_on();
@@ -577,9 +1167,29 @@ void frsky_do_clone_finish(void) {
     led_button_l_on();
 }
 
+// detected edges of the bind packet window
 static int8_t frsky_fscal0_min;
 static int8_t frsky_fscal0_max;
 
+static uint8_t frsky_autotune_state;
+// coarse scan: pass counter (odd passes are shifted by half a step),
+// probe index and the scores of all probes of this pass
+static uint8_t frsky_autotune_pass;
+static uint8_t frsky_autotune_index;
+static uint16_t frsky_autotune_coarse_score[FRSKY_AUTOTUNE_COARSE_COUNT];
+// edge bisection: the edge is between the hit and the miss offset.
+// -128 and 128 are virtual misses outside the fsctrl0 range
+static int16_t frsky_autotune_hit;
+static int16_t frsky_autotune_miss;
+// currently running probe
+static int16_t frsky_autotune_offset;
+static uint16_t frsky_autotune_score;
+// probe waits for the settle time (0) or listens (1)
+static uint8_t frsky_autotune_listening;
+static uint32_t frsky_autotune_probe_time;
+static uint32_t frsky_autotune_dwell;
+static uint8_t frsky_autotune_probe_count;
+
 void frsky_autotune_prepare(void) {
     debug("frsky: autotune\n"); debug_flush();
 
@@ -593,130 +1203,224 @@ void frsky_autotune_prepare(void) {
 
     led_button_r_off();
 
-    frsky_state = 0;
     frsky_fscal0_min = 127;
     frsky_fscal0_max = -127;
     frsky_bind_packet_received = 0;
-}
-
-uint32_t frsky_autotune_do(void) {
-    // search for best fscal 0 match
-    // reset wdt
-    wdt_reset();
 
-    // handle any ovf conditions
-    frsky_handle_overflows();
+    frsky_autotune_state = FRSKY_AUTOTUNE_STATE_COARSE;
+    frsky_autotune_pass  = 0;
+    frsky_autotune_index = 0;
+    frsky_autotune_probe_count = 0;
+    frsky_autotune_probe_start(frsky_autotune_coarse_offset(0));
+}
 
-    // search full range quickly using binary search
-    switch (frsky_state) {
-        default:
-        case (0):
-            // init left search:
-            storage.frsky_freq_offset = -127;
-            frsky_state = 1;
-            break;
+static int16_t frsky_autotune_coarse_offset(uint8_t index) {
+    int16_t offset = -120 + index * FRSKY_AUTOTUNE_COARSE_STEP;
+    if (frsky_autotune_pass & 1) {
+        // interleave with the previous pass to catch narrow windows
+        offset += FRSKY_AUTOTUNE_COARSE_STEP / 2;
+    }
+    return min(offset, 127);
+}
 
-        case (1):
-            // first search quickly through the full range:
-            if (storage.frsky_freq_offset < 127-10) {
-                storage.frsky_freq_offset += 9;
-            } else {
-                // done one search, did we receive anything?
-                if (frsky_bind_packet_received) {
-                    // finished, go to slow search
-                    storage.frsky_freq_offset = frsky_fscal0_min - 9;
-                    frsky_state = 2;
-                } else {
-                    // no success, lets try again
-                    frsky_state = 0;
-                }
-            }
-            break;
+static void frsky_autotune_probe_start(int16_t offset) {
+    frsky_autotune_offset = offset;
+    frsky_autotune_score  = 0;
+    frsky_autotune_probe_count++;
 
-        case (2):
-            if (storage.frsky_freq_offset < frsky_fscal0_max+9) {
-                storage.frsky_freq_offset++;
-            } else {
-                // done!
-                frsky_state = 5;
-            }
-            break;
-    }
+    storage.frsky_freq_offset = offset;
 
     // go to idle
     cc2500_strobe(RFST_SIDLE);
 
+    // drop packets received with the previous offset
+    cc2500_strobe(RFST_SFRX);
+    frsky_packet_received = 0;
+    frsky_rx_buffer[0] = 0x00;
+
     // set freq offset
     cc2500_set_register(FSCTRL0, storage.frsky_freq_offset);
 
-    led_button_r_off();
+    // rx is entered by frsky_autotune_do() after the settle time
+    frsky_autotune_listening = 0;
+    frsky_autotune_dwell = 0;
+    frsky_autotune_probe_time = rftiming_now();
+}
 
-    // go back to RX:
-    delay_ms(1);
-    cc2500_strobe(RFST_SRX);
+// a weak or distorted packet (high lqi value, low rssi) counts less
+static uint16_t frsky_autotune_packet_score(volatile uint8_t *buffer) {
+    uint8_t lqi  = buffer[FRSKY_PACKET_BUFFER_SIZE - 1] & 0x7F;
+    uint8_t rssi = frsky_extract_rssi(buffer[FRSKY_PACKET_BUFFER_SIZE - 2]);
+    return (0x7F - lqi) + rssi / 4;
+}
 
-    // set timeout
-    timeout_set(50);
+// returns 1 when the search is finished. never blocks, call this
+// repeatedly from the main loop
+uint32_t frsky_autotune_do(void) {
+    uint32_t now;
+    uint32_t elapsed;
 
-    led_button_l_on();
-    led_button_r_off();
+    if (frsky_autotune_state == FRSKY_AUTOTUNE_STATE_DONE) {
+        return 1;
+    }
 
-    // debug("tune "); debug_put_int8(storage.frsky_freq_offset);
-    // debug_put_newline(); debug_flush();
-    uint32_t done = 0;
-    while ((!timeout_timed_out()) && (!done)) {
+    // reset wdt
+    wdt_reset();
+
+    now = rftiming_now();
+    elapsed = now - frsky_autotune_probe_time;
+
+    if (!frsky_autotune_listening) {
+        // go back to RX once the new offset settled
+        if (elapsed >= FRSKY_AUTOTUNE_SETTLE_US) {
+            cc2500_strobe(RFST_SRX);
+            frsky_autotune_listening = 1;
+            frsky_autotune_probe_time = now;
+        }
+        return 0;
+    }
+
+    // only the time spent polling counts as dwell
+    frsky_autotune_probe_time = now;
+    if (elapsed < FRSKY_AUTOTUNE_POLL_GAP_US) {
+        frsky_autotune_dwell += elapsed;
+    }
+
+    // handle any ovf conditions
+    frsky_handle_overflows();
+
+    frsky_packet_received = 0;
+    cc2500_process_packet(&frsky_packet_received, \
+                          (volatile uint8_t *)&frsky_rx_buffer, \
+                          FRSKY_PACKET_BUFFER_SIZE);
+
+    if (frsky_packet_received) {
+        // prepare for next packet:
         frsky_packet_received = 0;
+        cc2500_enable_receive();
+        cc2500_strobe(RFST_SRX);
+
+        // valid packet?
+        if (FRSKY_VALID_PACKET_BIND(frsky_rx_buffer)) {
+            // bind packet!
+            debug_putc('B');
+            frsky_bind_packet_received = 1;
+            frsky_autotune_score += frsky_autotune_packet_score(frsky_rx_buffer);
 
-        // handle any ovf conditions
-        frsky_handle_overflows();
+            // make sure we never read the same packet twice by invalidating packet
+            frsky_rx_buffer[0] = 0x00;
+        }
+    }
+
+    // a hit ends the probe early, a miss needs the full dwell time
+    if (frsky_autotune_score >= FRSKY_AUTOTUNE_HIT_SCORE) {
+        frsky_autotune_next(1);
+    } else if (frsky_autotune_dwell >= FRSKY_AUTOTUNE_DWELL_US) {
+        debug_putc('-');
+        frsky_autotune_next(0);
+    }
 
-        cc2500_process_packet(&frsky_packet_received, \
-                              (volatile uint8_t *)&frsky_packet_buffer, \
-                              FRSKY_PACKET_BUFFER_SIZE);
+    return (frsky_autotune_state == FRSKY_AUTOTUNE_STATE_DONE);
+}
 
-        if (frsky_packet_received) {
-            // prepare for next packet:
-            frsky_packet_received = 0;
-            cc2500_enable_receive();
-            cc2500_strobe(RFST_SRX);
+// the coarse pass is done, pick the best probe and start the
+// bisection of the window edges around it
+static void frsky_autotune_coarse_done(void) {
+    uint8_t i;
+    uint8_t best = 0;
+    uint8_t lo, hi;
 
-            // valid packet?
-            if (FRSKY_VALID_PACKET_BIND(frsky_packet_buffer)) {
-                // bind packet!
-                debug_putc('B');
+    for (i = 1; i < FRSKY_AUTOTUNE_COARSE_COUNT; i++) {
+        if (frsky_autotune_coarse_score[i] > frsky_autotune_coarse_score[best]) {
+            best = i;
+        }
+    }
 
-                // packet received
-                frsky_bind_packet_received = 1;
+    if (frsky_autotune_coarse_score[best] < FRSKY_AUTOTUNE_HIT_SCORE) {
+        // no success, lets try again with shifted offsets
+        frsky_autotune_pass++;
+        frsky_autotune_index = 0;
+        frsky_autotune_probe_start(frsky_autotune_coarse_offset(0));
+        return;
+    }
 
-                // this fscal value is done
-                done = 1;
+    // extend to the contiguous run of hits around the best probe
+    lo = best;
+    while ((lo > 0) && (frsky_autotune_coarse_score[lo - 1] >= FRSKY_AUTOTUNE_HIT_SCORE)) {
+        lo--;
+    }
+    hi = best;
+    while ((hi < FRSKY_AUTOTUNE_COARSE_COUNT - 1) &&
+           (frsky_autotune_coarse_score[hi + 1] >= FRSKY_AUTOTUNE_HIT_SCORE)) {
+        hi++;
+    }
 
-                // update min/ max
-                frsky_fscal0_min = min(frsky_fscal0_min, storage.frsky_freq_offset);
-                frsky_fscal0_max = max(frsky_fscal0_max, storage.frsky_freq_offset);
+    frsky_fscal0_min = frsky_autotune_coarse_offset(lo);
+    frsky_fscal0_max = frsky_autotune_coarse_offset(hi);
 
-                // make sure we never read the same packet twice by invalidating packet
-                frsky_packet_buffer[0] = 0x00;
+    // lower edge is between the last miss and the first hit
+    frsky_autotune_state = FRSKY_AUTOTUNE_STATE_EDGE_LOW;
+    frsky_autotune_hit   = frsky_fscal0_min;
+    frsky_autotune_miss  = max(frsky_fscal0_min - FRSKY_AUTOTUNE_COARSE_STEP, -128);
+}
+
+static void frsky_autotune_next(uint8_t hit) {
+    switch (frsky_autotune_state) {
+        default:
+        case (FRSKY_AUTOTUNE_STATE_COARSE):
+            frsky_autotune_coarse_score[frsky_autotune_index] = frsky_autotune_score;
+            frsky_autotune_index++;
+            if (frsky_autotune_index < FRSKY_AUTOTUNE_COARSE_COUNT) {
+                frsky_autotune_probe_start(frsky_autotune_coarse_offset(frsky_autotune_index));
+                return;
             }
+            frsky_autotune_coarse_done();
+            if (frsky_autotune_state == FRSKY_AUTOTUNE_STATE_COARSE) {
+                // coarse pass restarted
+                return;
+            }
+            break;
 
-            /*debug("[");debug_flush();
-    uint8_t cnt;
-            for (cnt = 0; cnt < FRSKY_PACKET_BUFFER_SIZE; cnt++) {
-                debug_put_hex8(frsky_packet_buffer[cnt]);
-                debug_putc(' ');
-                debug_flush();
+        case (FRSKY_AUTOTUNE_STATE_EDGE_LOW):
+        case (FRSKY_AUTOTUNE_STATE_EDGE_HIGH):
+            if (hit) {
+                frsky_autotune_hit = frsky_autotune_offset;
+            } else {
+                frsky_autotune_miss = frsky_autotune_offset;
             }
-            debug("]\n"); debug_flush();*/
-        }
+            break;
     }
-    if (!done) {
-        debug_putc('-');
+
+    // bisection of the current edge finished?
+    if (abs(frsky_autotune_hit - frsky_autotune_miss) <= 1) {
+        if (frsky_autotune_state == FRSKY_AUTOTUNE_STATE_EDGE_LOW) {
+            frsky_fscal0_min = frsky_autotune_hit;
+            // upper edge is between the last hit and the next miss
+            frsky_autotune_state = FRSKY_AUTOTUNE_STATE_EDGE_HIGH;
+            frsky_autotune_hit   = frsky_fscal0_max;
+            frsky_autotune_miss  = min(frsky_fscal0_max + FRSKY_AUTOTUNE_COARSE_STEP, 128);
+        } else {
+            frsky_fscal0_max = frsky_autotune_hit;
+            frsky_autotune_state = FRSKY_AUTOTUNE_STATE_DONE;
+            return;
+        }
     }
-    debug_flush();
 
-    return (frsky_state == 5);
+    frsky_autotune_probe_start((frsky_autotune_hit + frsky_autotune_miss) / 2);
 }
 
+// search progress in percent, the bisection needs about
+// log2(COARSE_STEP) probes per edge
+uint8_t frsky_autotune_get_progress(void) {
+    switch (frsky_autotune_state) {
+        default:
+        case (FRSKY_AUTOTUNE_STATE_COARSE)    :
+            return (frsky_autotune_index * 60) / FRSKY_AUTOTUNE_COARSE_COUNT;
+        case (FRSKY_AUTOTUNE_STATE_EDGE_LOW)  : return 70;
+        case (FRSKY_AUTOTUNE_STATE_EDGE_HIGH) : return 85;
+        case (FRSKY_AUTOTUNE_STATE_DONE)      : return 100;
+    }
+}
 
 void frsky_autotune_finish(void) {
     // set offset to what we found out to be the best:
@@ -726,6 +1430,9 @@ void frsky_autotune_finish(void) {
     debug_put_int8(frsky_fscal0_min);
     debug(" - ");
     debug_put_int8(frsky_fscal0_max);
+    debug(" after ");
+    debug_put_uint8(frsky_autotune_probe_count);
+    debug(" probes");
     debug_put_newline();
     debug_flush();
 
@@ -801,6 +1508,25 @@ void frsky_tune_channel(uint8_t ch) {
     // now FSCAL3..1 shold be set up correctly! yay!
 }
 
+// same as frsky_handle_overflows() but queued, used from within the rf isr
+static void frsky_queue_handle_overflows(void) {
+    // fetch marc status
+    cc2500_queue_register_read(MARCSTATE, 1, frsky_marcstate_callback);
+}
+
+static void frsky_marcstate_callback(uint8_t *data, uint8_t UNUSED(len)) {
+    uint8_t marc_state = data[0] & 0x1F;
+    if (marc_state == 0x11) {
+        debug("frsky: RXOVF\n");
+        // flush rx buf
+        cc2500_queue_strobe(RFST_SFRX);
+    } else if (marc_state == 0x16) {
+        debug("frsky: TXOVF\n");
+        // flush tx buf
+        cc2500_queue_strobe(RFST_SFTX);
+    }
+}
+
 void frsky_handle_overflows(void) {
     uint8_t marc_state;
 
@@ -869,7 +1595,7 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
     }
 
     // process incoming data
-    cc2500_process_packet(&frsky_packet_received, (volatile uint8_t *)&frsky_packet_buffer, \
+    cc2500_process_packet(&frsky_packet_received, (volatile uint8_t *)&frsky_rx_buffer, \
                           FRSKY_PACKET_BUFFER_SIZE);
 
     if (frsky_packet_received) {
@@ -882,11 +1608,11 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
 
 
 #if FRSKY_DEBUG_BIND_DATA
-        if (FRSKY_VALID_FRAMELENGTH(frsky_packet_buffer)) {
+        if (FRSKY_VALID_FRAMELENGTH(frsky_rx_buffer)) {
             debug("frsky: RX ");
             debug_flush();
             for (i = 0; i < FRSKY_PACKET_BUFFER_SIZE; i++) {
-                debug_put_hex8(frsky_packet_buffer[i]);
+                debug_put_hex8(frsky_rx_buffer[i]);
                 debug_putc(' ');
             }
             debug_put_newline();
@@ -895,7 +1621,7 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
 
 
         // do we know our txid yet?
-        if (FRSKY_VALID_PACKET_BIND(frsky_packet_buffer)) {
+        if (FRSKY_VALID_PACKET_BIND(frsky_rx_buffer)) {
             // next packet should be ther ein 9ms
             // if no packet for 3*9ms -> reset rx chain:
             timeout_set(3*9+1);
@@ -903,8 +1629,8 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
             debug_putc('B');
             if ((storage.frsky_txid[0] == 0) && (storage.frsky_txid[1] == 0)) {
                 // no! extract this
-                storage.frsky_txid[0] = frsky_packet_buffer[3];
-                storage.frsky_txid[1] = frsky_packet_buffer[4];
+                storage.frsky_txid[0] = frsky_rx_buffer[3];
+                storage.frsky_txid[1] = frsky_rx_buffer[4];
                 // debug
                 debug("\nfrsky: got txid 0x");
                 debug_put_hex8(storage.frsky_txid[0]);
@@ -913,14 +1639,14 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
             }
 
             // this is actually for us
-            uint8_t index = frsky_packet_buffer[5];
+            uint8_t index = frsky_rx_buffer[5];
 
             // valid bind index?
             if (index/ 5 < MAX_BIND_PACKET_COUNT) {
                 // copy data to our hop list:
                 for (i = 0; i < 5; i++) {
                     if ((index+i) < FRSKY_HOPTABLE_SIZE) {
-                        storage.frsky_hop_table[index+i] = frsky_packet_buffer[6+i];
+                        storage.frsky_hop_table[index+i] = frsky_rx_buffer[6+i];
                     }
                 }
                 // mark as done: set bit flag for index
@@ -932,7 +1658,7 @@ uint32_t frsky_fetch_txid_and_hoptable_do(void) {
             }
 
             // make sure we never read the same packet twice by crc flag
-            frsky_packet_buffer[FRSKY_PACKET_BUFFER_SIZE-1] = 0x00;
+            frsky_rx_buffer[FRSKY_PACKET_BUFFER_SIZE-1] = 0x00;
         }
     }
     debug_put_uint8(frsky_bind_packet_hoptable_flags);
@@ -999,6 +1725,9 @@ void frsky_calib_pll(void) {
     // return to idle
     cc2500_strobe(RFST_SIDLE);
 
+    // precompute the register writes for every hop
+    frsky_build_hop_images();
+
     debug("...\nfrsky: calib fscal0 = ");
     debug_put_int8(storage.frsky_freq_offset);
     debug("\nfrsky: calib fscal1:\n");
@@ -1016,20 +1745,113 @@ void frsky_calib_pll(void) {
     debug("frsky: calib pll done\n");
 }
 
-void frsky_set_channel(uint8_t hop_index) {
-    uint8_t ch = storage.frsky_hop_table[hop_index];
-    // debug_putc('S'); debug_put_hex8(ch);
+// the cache is only valid for the same hop table and offset
+static uint16_t frsky_calib_cache_key(void) {
+    uint8_t data[FRSKY_HOPTABLE_SIZE + 1];
+    uint8_t i;
 
-    // go to idle
-    cc2500_strobe(RFST_SIDLE);
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        data[i] = storage.frsky_hop_table[i];
+    }
+    data[FRSKY_HOPTABLE_SIZE] = storage.frsky_freq_offset;
 
-    // fetch and set our stored pll calib data:
-    cc2500_set_register(FSCAL3, frsky_calib_fscal3);
-    cc2500_set_register(FSCAL2, frsky_calib_fscal2);
-    cc2500_set_register(FSCAL1, frsky_calib_fscal1_table[hop_index]);
+    uint16_t key = crc16_ccitt(data, sizeof(data));
 
-    // set channel
-    cc2500_set_register(CHANNR, ch);
+    // 0 marks an empty cache
+    return (key == 0) ? 1 : key;
+}
+
+// copy the live calibration to the cache in ram. this is not written to flash
+// here, a flash write stalls the cpu (and the rf isr). the cache is stored
+// with the next storage_save() triggered by the user
+static void frsky_calib_cache_update(void) {
+    uint8_t i;
+
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        storage.frsky_calib_fscal1[i] = frsky_calib_fscal1_table[i];
+    }
+    storage.frsky_calib_fscal2 = frsky_calib_fscal2;
+    storage.frsky_calib_fscal3 = frsky_calib_fscal3;
+    storage.frsky_calib_temperature = adc_get_temperature();
+    storage.frsky_calib_key = frsky_calib_cache_key();
+}
+
+static void frsky_calib_pll_cached(void) {
+    int16_t temperature = adc_get_temperature();
+    uint8_t i;
+
+    frsky_calib_cache_hit = 0;
+
+    // the stored temperature is the one of the calibration, a radio booting
+    // close to it always hits instead of toggling between two buckets
+    if ((storage.frsky_calib_key == frsky_calib_cache_key()) &&
+        (abs(temperature - storage.frsky_calib_temperature) <= FRSKY_CALIB_CACHE_TEMP_RANGE)) {
+        debug("frsky: calib cache hit\n"); debug_flush();
+
+        for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+            frsky_calib_fscal1_table[i] = storage.frsky_calib_fscal1[i];
+        }
+        frsky_calib_fscal2 = storage.frsky_calib_fscal2;
+        frsky_calib_fscal3 = storage.frsky_calib_fscal3;
+
+        frsky_build_hop_images();
+
+        // validated by the rolling recalibration
+        frsky_calib_cache_checked  = 0;
+        frsky_calib_cache_mismatch = 0;
+        frsky_calib_cache_hit = 1;
+        return;
+    }
+
+    debug("frsky: calib cache miss\n"); debug_flush();
+
+    // tune all channels
+    frsky_calib_pll();
+
+    // and keep the result for the next boot
+    frsky_calib_cache_update();
+}
+
+// runs in the main loop
+static void frsky_calib_cache_validate(void) {
+    if (!frsky_calib_cache_hit || (frsky_calib_cache_checked < FRSKY_HOPTABLE_SIZE)) {
+        return;
+    }
+    frsky_calib_cache_hit = 0;
+
+    debug("frsky: calib cache mismatch ");
+    debug_put_uint8(frsky_calib_cache_mismatch);
+    debug_put_newline();
+    debug_flush();
+
+    if (frsky_calib_cache_mismatch) {
+        // the live calibration is fresh already, replace the cache with it
+        frsky_calib_cache_update();
+    }
+}
+
+static void frsky_build_hop_images(void) {
+    uint8_t i;
+
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        uint8_t *image = frsky_hop_image[i];
+        // go to idle
+        image[0] = RFST_SIDLE;
+        // set channel
+        image[1] = CHANNR;
+        image[FRSKY_HOP_IMAGE_CHANNR] = storage.frsky_hop_table[i];
+        // and our stored pll calib data, burst has to be the last access
+        image[3] = FSCAL3 | BURST_FLAG;
+        image[FRSKY_HOP_IMAGE_FSCAL3] = frsky_calib_fscal3;
+        image[FRSKY_HOP_IMAGE_FSCAL2] = frsky_calib_fscal2;
+        image[FRSKY_HOP_IMAGE_FSCAL1] = frsky_calib_fscal1_table[i];
+    }
+}
+
+// NOTE: this is queued, it is only used from within the rf isr
+void frsky_set_channel(uint8_t hop_index) {
+    // go to idle, set channel and pll calib data with a single burst
+    cc2500_queue_write_raw(frsky_hop_image[hop_index], FRSKY_HOP_IMAGE_SIZE);
 }
 
 
@@ -1094,10 +1916,6 @@ void frsky_send_telemetry(uint8_t telemetry_id) {
     // append any received hub telemetry data
     /// telemetry_fill_buffer(&frsky_packet_buffer[6], telemetry_id);
 
-    // re arm adc dma etc
-    // it is important to call this after reading the values...
-    adc_process();
-
     // send packet
     cc2500_transmit_packet(frsky_packet_buffer, FRSKY_PACKET_BUFFER_SIZE);
 
@@ -28,7 +28,49 @@
 #define FRSKY_HOPTABLE_SIZE 47
 #define FRSKY_PACKET_LENGTH 17
 #define FRSKY_PACKET_BUFFER_SIZE (FRSKY_PACKET_LENGTH+3)
-#define FRSKY_COUNT_RXSTATS 20
+
+// per hop register image, sent as one spi burst:
+// SIDLE, CHANNR = ch, FSCAL3..1 (burst)
+#define FRSKY_HOP_IMAGE_SIZE   7
+#define FRSKY_HOP_IMAGE_CHANNR 2
+#define FRSKY_HOP_IMAGE_FSCAL3 4
+#define FRSKY_HOP_IMAGE_FSCAL2 5
+#define FRSKY_HOP_IMAGE_FSCAL1 6
+
+// supported protocols
+#define FRSKY_PROTOCOL_D8    0
+#define FRSKY_PROTOCOL_D16   1
+#define FRSKY_PROTOCOL_COUNT 2
+
+// actions run by the rf slot engine (tim3 isr)
+#define FRSKY_SLOT_TX           0  // hop and send the prepared packet
+#define FRSKY_SLOT_TX_CHECK     1  // as above, check for fifo overflows first
+#define FRSKY_SLOT_TX_AFTER_RX  2  // as above, telemetry slot is over
+#define FRSKY_SLOT_RX_PREPARE   3  // hop and enable the lna
+#define FRSKY_SLOT_RX           4  // enter rx, telemetry slot starts
+#define FRSKY_SLOT_BIND_PREPARE 5  // set up bind address and channel
+#define FRSKY_SLOT_BIND_TX      6  // send the next bind packet
+#define FRSKY_SLOT_CALIBRATE    7  // recalibrate one hop channel after tx
+#define FRSKY_SLOT_SENDS(_a) (((_a) <= FRSKY_SLOT_TX_AFTER_RX) || ((_a) == FRSKY_SLOT_BIND_TX))
+
+// one slot of a schedule
+typedef struct {
+    uint8_t action;
+    // index of the following slot
+    uint8_t next;
+    // time until the following slot in us
+    uint16_t duration;
+} frsky_slot_t;
+
+typedef struct {
+    const frsky_slot_t *slots;
+    char *name;
+} frsky_schedule_t;
+
+// user selectable schedules
+#define FRSKY_SCHEDULE_D8_TELEMETRY     0
+#define FRSKY_SCHEDULE_D8_NO_TELEMETRY  1
+#define FRSKY_SCHEDULE_COUNT            2
 
 void frsky_init(void);
 uint8_t frsky_check_transceiver(void);
@@ -50,13 +92,14 @@ void frsky_increment_channel(int8_t cnt);
 void frsky_tx_set_enabled(uint32_t enabled);
 void frsky_set_channel(uint8_t hop_index);
 void frsky_send_telemetry(uint8_t telemetry_id);
-void frsky_send_bindpacket(uint8_t bind_packet_id);
+void frsky_send_bindpacket(void);
 
 
 void frsky_do_clone_prepare(void);
 void frsky_do_clone_finish(void);
 void frsky_autotune_prepare(void);
 uint32_t frsky_autotune_do(void);
+uint8_t frsky_autotune_get_progress(void);
 void frsky_autotune_finish(void);
 void frsky_fetch_txid_and_hoptable_prepare(void);
 uint32_t frsky_fetch_txid_and_hoptable_do(void);
@@ -64,7 +107,23 @@ void frsky_fetch_txid_and_hoptable_finish(void);
 
 void frsky_init_timer(void);
 
+// link state as seen by the last receive slot
+typedef struct {
+    // filtered rssi of our signal at the receiver
+    uint8_t rssi;
+    // filtered rssi of the telemetry at our side
+    uint8_t rssi_telemetry;
+    // receive slots without a valid packet
+    uint8_t lost_packets;
+} frsky_link_stats_t;
+
+void frsky_get_link_stats(frsky_link_stats_t *stats);
 void frsky_get_rssi(uint8_t *rssi, uint8_t *rssi_telemetry);
+void frsky_set_schedule(uint8_t schedule_id);
+char *frsky_get_schedule_name(uint8_t schedule_id);
+void frsky_set_protocol(uint8_t protocol);
+char *frsky_get_protocol_name(uint8_t protocol);
+int8_t frsky_get_afc_offset(void);
 
 // extern uint8_t frsky_current_ch_idx;
 // extern uint8_t frsky_diversity_count;
@@ -0,0 +1,201 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#include "frsky_d16.h"
+#include "frsky.h"
+#include "cc2500.h"
+#include "crc16.h"
+#include "debug.h"
+#include "storage.h"
+
+// alternates between ch1..8 and ch9..16
+static uint8_t frsky_d16_upper_group;
+// hop table index increment, sent in every packet
+static uint8_t frsky_d16_chanskip;
+
+// d16 radio configuration, loaded by frsky_configure()
+const cc2500_profile_t frsky_d16_profile = {
+    "D16",
+    {
+        [IOCFG2]   = 0x01,                // overwritten by cc2500_set_gdo_mode()
+        [IOCFG1]   = 0x2E,
+        [IOCFG0]   = 0x01,
+        [FIFOTHR]  = 0x07,
+        [SYNC1]    = 0xD3,
+        [SYNC0]    = 0x91,
+        [PKTLEN]   = FRSKY_D16_PACKET_LENGTH + 1,
+        [PKTCTRL1] = CC2500_PKTCTRL1_APPEND_STATUS,  // see frsky_configure_address()
+        [PKTCTRL0] = 0x01,                // variable length, crc is done in software
+        [ADDR]     = 0x00,
+        [CHANNR]   = 0x00,
+        [FSCTRL1]  = 0x0A,
+        [FSCTRL0]  = 0x00,
+        [FREQ2]    = 0x5C,                // base freq 2404 mhz
+        [FREQ1]    = 0x76,
+        [FREQ0]    = 0x27,
+        [MDMCFG4]  = 0x7B,
+        [MDMCFG3]  = 0x61,
+        [MDMCFG2]  = 0x13,
+        [MDMCFG1]  = 0x23,
+        [MDMCFG0]  = 0x7A,
+        [DEVIATN]  = 0x51,
+        [MCSM2]    = 0x07,
+        [MCSM1]    = 0x0F,                // go back to rx after transmission completed
+        [MCSM0]    = 0x18,
+        [FOCCFG]   = 0x16,
+        [BSCFG]    = 0x6C,
+        [AGCCTRL2] = 0x03,
+        [AGCCTRL1] = 0x40,                // D4R uses 46 instead of 0x40
+        [AGCCTRL0] = 0x91,
+        [WOREVT1]  = 0x87,
+        [WOREVT0]  = 0x6B,
+        [WORCTRL]  = 0xF8,
+        [FREND1]   = 0x56,
+        [FREND0]   = 0x10,
+        [FSCAL3]   = 0xA9,
+        [FSCAL2]   = 0x05,
+        [FSCAL1]   = 0x00,
+        [FSCAL0]   = 0x11,
+        [RCCTRL1]  = 0x41,
+        [RCCTRL0]  = 0x00,
+        [FSTEST]   = 0x59,
+        [PTEST]    = 0x7F,
+        [AGCTEST]  = 0x3F,
+        [TEST2]    = 0x88,
+        [TEST1]    = 0x31,
+        [TEST0]    = 0x0B,
+    },
+    0xFF  // PA_TABLE0
+};
+
+// internal functions
+static uint16_t frsky_d16_channel(uint16_t d8_value);
+static void frsky_d16_append_crc(volatile uint8_t *buffer);
+
+void frsky_d16_init(void) {
+    debug("frsky_d16: init\n"); debug_flush();
+
+    frsky_d16_upper_group = 0;
+
+    // the hoptable size is prime, thus every skip value visits all channels.
+    // derive it from the txid so that it stays the same across reboots
+    frsky_d16_chanskip = 5 + ((storage.frsky_txid[0] ^ storage.frsky_txid[1]) % (FRSKY_HOPTABLE_SIZE - 10));
+
+    debug("frsky_d16: chanskip ");
+    debug_put_uint8(frsky_d16_chanskip);
+    debug_put_newline();
+    debug_flush();
+}
+
+uint8_t frsky_d16_get_chanskip(void) {
+    return frsky_d16_chanskip;
+}
+
+static uint16_t frsky_d16_channel(uint16_t d8_value) {
+    if (d8_value < FRSKY_D16_CHANNEL_FROM_D8_OFFSET) {
+        return 0;
+    }
+    return min(d8_value - FRSKY_D16_CHANNEL_FROM_D8_OFFSET, FRSKY_D16_CHANNEL_MAX);
+}
+
+static void frsky_d16_append_crc(volatile uint8_t *buffer) {
+    // the buffer is not touched by the rf isr while we build it
+    uint16_t crc = crc16_ccitt((uint8_t *)&buffer[FRSKY_D16_CRC_START],
+                               FRSKY_D16_CRC_END - FRSKY_D16_CRC_START);
+    buffer[FRSKY_D16_CRC_END]     = crc >> 8;
+    buffer[FRSKY_D16_CRC_END + 1] = crc & 0xFF;
+}
+
+// channel_data holds 8 channels in d8 packet format (us * 1.5)
+void frsky_d16_build_packet(volatile uint8_t *buffer, uint8_t hop_index, uint16_t *channel_data) {
+    uint8_t i;
+
+    // packet length
+    buffer[0] = FRSKY_D16_PACKET_LENGTH;
+    // txid
+    buffer[1] = storage.frsky_txid[0];
+    buffer[2] = storage.frsky_txid[1];
+    buffer[3] = 0x02;
+    // hop index of this packet and chanskip
+    buffer[4] = (frsky_d16_chanskip << 6) | hop_index;
+    buffer[5] = frsky_d16_chanskip >> 2;
+    buffer[6] = FRSKY_D16_RX_NUM;
+    // no failsafe data
+    buffer[7] = 0x00;
+    buffer[8] = 0x00;
+
+    // 9 .. 20 is 8 channels, packed 2x12 bit into 3 bytes
+    for (i = 0; i < 8; i += 2) {
+        uint16_t ch0, ch1;
+        if (frsky_d16_upper_group) {
+            // there are no sources for ch9..16 yet, send center
+            ch0 = FRSKY_D16_CHANNEL_CENTER | FRSKY_D16_CHANNEL_UPPER_FLAG;
+            ch1 = FRSKY_D16_CHANNEL_CENTER | FRSKY_D16_CHANNEL_UPPER_FLAG;
+        } else {
+            ch0 = frsky_d16_channel(channel_data[i]);
+            ch1 = frsky_d16_channel(channel_data[i + 1]);
+        }
+        buffer[9 + (i / 2) * 3]     = ch0 & 0xFF;
+        buffer[9 + (i / 2) * 3 + 1] = ((ch0 >> 8) & 0x0F) | (ch1 << 4);
+        buffer[9 + (i / 2) * 3 + 2] = ch1 >> 4;
+    }
+    frsky_d16_upper_group ^= 1;
+
+    // no s.port data
+    buffer[21] = FRSKY_D16_TELEMETRY_SEQ;
+    for (i = 22; i < FRSKY_D16_CRC_END; i++) {
+        buffer[i] = 0;
+    }
+
+    frsky_d16_append_crc(buffer);
+}
+
+void frsky_d16_build_bindpacket(volatile uint8_t *buffer, uint8_t bind_packet_id) {
+    uint8_t i;
+
+    buffer[0] = FRSKY_D16_PACKET_LENGTH;
+    // bind identifier
+    buffer[1] = 0x03;
+    buffer[2] = 0x01;
+    // txid
+    buffer[3] = storage.frsky_txid[0];
+    buffer[4] = storage.frsky_txid[1];
+    // hoptable index
+    buffer[5] = bind_packet_id * 5;
+
+    // add a maximum of 5 bytes hoptable data
+    for (i = 0; i < 5; i++) {
+        uint8_t index = bind_packet_id * 5 + i;
+        if (index < FRSKY_HOPTABLE_SIZE) {
+            buffer[6 + i] = storage.frsky_hop_table[index];
+        } else {
+            buffer[6 + i] = 0;
+        }
+    }
+
+    buffer[11] = 0x02;
+    buffer[12] = FRSKY_D16_RX_NUM;
+
+    // fill with zeros
+    for (i = 13; i < FRSKY_D16_CRC_END; i++) {
+        buffer[i] = 0;
+    }
+
+    frsky_d16_append_crc(buffer);
+}
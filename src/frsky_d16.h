@@ -0,0 +1,53 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#ifndef FRSKY_D16_H_
+#define FRSKY_D16_H_
+
+#include <stdint.h>
+#include "cc2500.h"
+
+// d16 (accst x) frame: 0x1D length byte, 27 bytes payload, 2 bytes crc
+#define FRSKY_D16_PACKET_LENGTH      0x1D
+#define FRSKY_D16_PACKET_BUFFER_SIZE (FRSKY_D16_PACKET_LENGTH + 1)
+// crc16 ccitt is calculated over packet[3..27]
+#define FRSKY_D16_CRC_START 3
+#define FRSKY_D16_CRC_END   (FRSKY_D16_PACKET_BUFFER_SIZE - 2)
+
+// receiver number (model match), not used yet
+#define FRSKY_D16_RX_NUM 0
+// telemetry sequence byte when no s.port data is exchanged
+#define FRSKY_D16_TELEMETRY_SEQ 0x08
+
+// channel data: 11 bit, 1024 is center, bit 11 marks ch9..16
+#define FRSKY_D16_CHANNEL_CENTER     1024
+#define FRSKY_D16_CHANNEL_MAX        2047
+#define FRSKY_D16_CHANNEL_UPPER_FLAG 2048
+// d8 packet data is us * 1.5, 2250 (1500us) maps to 1024
+#define FRSKY_D16_CHANNEL_FROM_D8_OFFSET 1226
+
+// cc2500 register profile, selected by frsky_configure()
+extern const cc2500_profile_t frsky_d16_profile;
+
+void frsky_d16_init(void);
+uint8_t frsky_d16_get_chanskip(void);
+void frsky_d16_build_packet(volatile uint8_t *buffer, uint8_t hop_index, uint16_t *channel_data);
+void frsky_d16_build_bindpacket(volatile uint8_t *buffer, uint8_t bind_packet_id);
+
+#endif  // FRSKY_D16_H_
@@ -35,6 +35,11 @@
 #include "touch.h"
 #include "screen.h"
 #include "assert.h"
+#include "frsky.h"
+#include "rftiming.h"
+#include "linkstats.h"
+#include "mixer.h"
+#include "lswitch.h"
 
 static uint32_t gui_config_counter;
 static uint32_t gui_shutdown_pressed;
@@ -71,6 +76,8 @@ static void gui_cb_model_next(void);
 static void gui_cb_setting_model_stickscale(void);
 static void gui_cb_setting_model_name(void);
 static void gui_cb_setting_model_timer(void);
+static void gui_cb_setting_model_schedule(void);
+static void gui_cb_setting_model_protocol(void);
 static void gui_cb_setting_option_leave(void);
 static void gui_cb_previous_page(void);
 static void gui_cb_next_page(void);
@@ -82,6 +89,10 @@ static void gui_cb_config_exit(void);
 static void gui_cb_setup_clonetx(void);
 static void gui_cb_setup_bootloader(void);
 static void gui_cb_setup_exit(void);
+static void gui_cb_rftiming_dump(void);
+static void gui_cb_rftiming_reset(void);
+static void gui_cb_linkstats_dump(void);
+static void gui_cb_linkstats_reset(void);
 
 // rendering
 static void gui_render_main_screen(void);
@@ -92,6 +103,8 @@ static void gui_render_battery(void);
 static void gui_render_statusbar(void);
 static void gui_render_bottombar(void);
 static void gui_render_settings(void);
+static void gui_render_rftiming(void);
+static void gui_render_linkstats(void);
 static void gui_render_rssi(void);
 static void gui_config_main_render(void);
 static void gui_config_model_render(void);
@@ -172,7 +185,7 @@ static void gui_touch_callback_execute(uint8_t i) {
 
 static void gui_add_button_smallfont(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
                                      char *str, f_ptr_t cb) {
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
     gui_add_button(x, y, w, h, str, cb);
 }
 
@@ -224,12 +237,22 @@ static void gui_cb_model_timer_reload(void) {
 static void gui_cb_model_prev(void) {
     if (storage.current_model > 0) {
         storage.current_model--;
+        frsky_set_protocol(storage.model[storage.current_model].protocol);
+        frsky_set_schedule(storage.model[storage.current_model].rf_schedule);
+        adc_calibration_update();
+        mixer_compile();
+        lswitch_compile();
     }
 }
 
 static void gui_cb_model_next(void) {
     if (storage.current_model < (STORAGE_MODEL_MAX_COUNT-1)) {
         storage.current_model++;
+        frsky_set_protocol(storage.model[storage.current_model].protocol);
+        frsky_set_schedule(storage.model[storage.current_model].rf_schedule);
+        adc_calibration_update();
+        mixer_compile();
+        lswitch_compile();
     }
 }
 
@@ -248,6 +271,16 @@ static void gui_cb_setting_model_timer(void) {
     gui_sub_page = GUI_SUBPAGE_SETTING_MODEL_TIMER;
 }
 
+static void gui_cb_setting_model_schedule(void) {
+    gui_page    |= GUI_PAGE_CONFIG_OPTION_FLAG;
+    gui_sub_page = GUI_SUBPAGE_SETTING_MODEL_SCHEDULE;
+}
+
+static void gui_cb_setting_model_protocol(void) {
+    gui_page    |= GUI_PAGE_CONFIG_OPTION_FLAG;
+    gui_sub_page = GUI_SUBPAGE_SETTING_MODEL_PROTOCOL;
+}
+
 static void gui_cb_setting_option_leave(void) {
     gui_page &= ~GUI_PAGE_CONFIG_OPTION_FLAG;
 }
@@ -255,12 +288,14 @@ static void gui_cb_setting_option_leave(void) {
 static void gui_cb_model_stickscale_dec(void) {
     if (storage.model[storage.current_model].stick_scale > 2) {
         storage.model[storage.current_model].stick_scale--;
+        adc_calibration_update();
     }
 }
 
 static void gui_cb_model_stickscale_inc(void) {
     if (storage.model[storage.current_model].stick_scale < 100) {
         storage.model[storage.current_model].stick_scale++;
+        adc_calibration_update();
     }
 }
 
@@ -276,6 +311,34 @@ static void gui_cb_model_timer_inc(void) {
     }
 }
 
+static void gui_cb_model_schedule_dec(void) {
+    if (storage.model[storage.current_model].rf_schedule > 0) {
+        storage.model[storage.current_model].rf_schedule--;
+        frsky_set_schedule(storage.model[storage.current_model].rf_schedule);
+    }
+}
+
+static void gui_cb_model_schedule_inc(void) {
+    if (storage.model[storage.current_model].rf_schedule < (FRSKY_SCHEDULE_COUNT-1)) {
+        storage.model[storage.current_model].rf_schedule++;
+        frsky_set_schedule(storage.model[storage.current_model].rf_schedule);
+    }
+}
+
+static void gui_cb_model_protocol_dec(void) {
+    if (storage.model[storage.current_model].protocol > 0) {
+        storage.model[storage.current_model].protocol--;
+        frsky_set_protocol(storage.model[storage.current_model].protocol);
+    }
+}
+
+static void gui_cb_model_protocol_inc(void) {
+    if (storage.model[storage.current_model].protocol < (FRSKY_PROTOCOL_COUNT-1)) {
+        storage.model[storage.current_model].protocol++;
+        frsky_set_protocol(storage.model[storage.current_model].protocol);
+    }
+}
+
 static void gui_cb_previous_page(void) {
     if (gui_page > 0) {
         gui_page--;
@@ -382,7 +445,19 @@ static void gui_handle_buttons(void) {
 }
 
 static void gui_process_logic(void) {
+    MODEL_DESC *model = &storage.model[storage.current_model];
     uint32_t second_elapsed = 0;
+    lswitch_state_t changes;
+    uint32_t i;
+
+    // beep on changes of switches that ask for it
+    changes = lswitch_fetch_changes();
+    for (i = 0; changes && (i < STORAGE_LSWITCH_COUNT); i++) {
+        if ((changes & (1 << i)) && (model->lswitch[i].func & STORAGE_LSWITCH_FLAG_BEEP)) {
+            sound_play_click();
+            break;
+        }
+    }
 
     if (timeout2_timed_out()) {
         // one second has passed
@@ -391,8 +466,14 @@ static void gui_process_logic(void) {
         timeout2_set_100us(10000);
     }
 
-    // count down when
-    if (adc_get_channel_rescaled(CHANNEL_ID_THROTTLE) >= ADC_RESCALED_ZERO_THRESHOLD) {
+    // low cell alarm, only on live data
+    if (second_elapsed && telemetry_sensor_fresh(TELEMETRY_SENSOR_CELL_MIN) &&
+        (telemetry_get_value(TELEMETRY_SENSOR_CELL_MIN) < GUI_ALARM_CELL_VOLTAGE)) {
+        sound_play_low_time();
+    }
+
+    // count down while the timer switch is on
+    if (lswitch_is_on(model->timer_switch)) {
         // do timer logic, handle countdown
         if (second_elapsed) {
             gui_model_timer--;
@@ -408,6 +489,9 @@ void gui_loop(void) {
     debug("gui: entering main loop\n"); debug_flush();
     gui_active = 1;
 
+    // the boot console might have moved the lcd start line
+    console_scroll_stop();
+
     // start with main page
     gui_page = GUI_PAGE_MAIN;
     gui_loop_counter = 0;
@@ -531,11 +615,11 @@ static void gui_render_rssi(void) {
     frsky_get_rssi(&rssi, &rssi_telemetry);
 
     screen_put_uint8(x, 1, 0, rssi_telemetry);
-    x += (GUI_STATUSBAR_FONT[FONT_FIXED_WIDTH]+1) * 3;
+    x += (GUI_STATUSBAR_FONT->width+1) * 3;
     screen_puts_xy(x, 1, 0, "|");
-    x += (GUI_STATUSBAR_FONT[FONT_FIXED_WIDTH]+1) * 1;
+    x += (GUI_STATUSBAR_FONT->width+1) * 1;
     screen_put_uint8(x, 1, 0, rssi);
-    x += (GUI_STATUSBAR_FONT[FONT_FIXED_WIDTH]+1) * 3;
+    x += (GUI_STATUSBAR_FONT->width+1) * 3;
 
     // render tx rssi bargraph at a given position
     screen_fill_rect(x, 1, GUI_RSSI_BAR_W+1, 5, 0);
@@ -568,7 +652,7 @@ static void gui_render_bottombar(void) {
     // draw black border
     screen_fill_rect(0, LCD_HEIGHT - 7, LCD_WIDTH, 7, 1);
 
-    screen_set_font(font_tomthumb3x5, &h, 0);
+    screen_set_font(&font_tomthumb3x5, &h, 0);
     screen_puts_centered(LCD_HEIGHT - 7 + h/2, 0,
                          storage.model[storage.current_model].name);
 }
@@ -583,7 +667,7 @@ static void gui_render_sliders(void) {
     // add statusbar
     gui_render_statusbar();
 
-    screen_set_font(font_tomthumb3x5, &h, 0);
+    screen_set_font(&font_tomthumb3x5, &h, 0);
 
     for (i = 0; i < 8; i++) {
         // render channel names
@@ -624,6 +708,7 @@ static void gui_config_stick_calibration_store_adc_values(void) {
         storage.stick_calibration[i][2] =
                 max(adc_get_channel(i), storage.stick_calibration[i][2]);
     }
+    adc_calibration_update();
 }
 
 
@@ -654,12 +739,22 @@ void gui_render(void) {
             // setup and config screen
             gui_render_settings();
             break;
+
+        case (GUI_PAGE_RFTIMING) :
+            // rf timing diagnostics
+            gui_render_rftiming();
+            break;
+
+        case (GUI_PAGE_LINKSTATS) :
+            // per hop link quality
+            gui_render_linkstats();
+            break;
     }
     screen_update();
 }
 
 static void gui_render_settings(void) {
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
 
     // render buttons and set callback
     gui_add_button_smallfont(64-50/2, 10, 50, 15, "SETUP",  &gui_cb_setup_enter);
@@ -667,6 +762,133 @@ static void gui_render_settings(void) {
 }
 
 
+static void gui_cb_rftiming_dump(void) {
+    rftiming_dump();
+}
+
+static void gui_cb_rftiming_reset(void) {
+    rftiming_reset();
+}
+
+static void gui_render_rftiming(void) {
+    uint32_t h, w;
+    uint32_t i;
+    uint32_t y;
+    rftiming_stat_t stat;
+    uint16_t histogram[RFTIMING_HISTOGRAM_BINS];
+
+    screen_set_font(&font_tomthumb3x5, &h, &w);
+
+    // isr time per schedule slot
+    y = 1;
+    screen_puts_xy(1 + 4*w, y, 1, "MIN AVG MAX");
+    y += h;
+    for (i = 0; i < RFTIMING_SLOT_COUNT; i++) {
+        rftiming_get_slot_stat(i, &stat);
+        if (stat.count == 0) {
+            continue;
+        }
+        if (y + h > LCD_HEIGHT) {
+            // no more space, see debug dump
+            break;
+        }
+        screen_put_uint8(1, y, 1, i);
+        screen_put_uint14(1 + 3*w,  y, 1, stat.min);
+        screen_put_uint14(1 + 7*w,  y, 1, rftiming_stat_mean(&stat));
+        screen_put_uint14(1 + 11*w, y, 1, stat.max);
+        y += h;
+    }
+
+    // strobe latency from the slot start
+    y = 1;
+    for (i = 0; i < RFTIMING_STROBE_COUNT; i++) {
+        rftiming_get_strobe_stat(i, &stat);
+        screen_puts_xy(66, y, 1, (i == RFTIMING_STROBE_STX) ? "STX" : "SRX");
+        screen_put_uint14(66 + 3*w, y, 1, rftiming_stat_mean(&stat));
+        screen_put_uint14(66 + 7*w, y, 1, stat.max);
+        y += h;
+    }
+
+    // tracked frequency offset
+    screen_puts_xy(66, y, 1, "AFC");
+    screen_put_int8(66 + 3*w, y, 1, frsky_get_afc_offset());
+    y += h;
+
+    // age of the stick data at stx in ms
+    rftiming_get_stick_age_stat(&stat);
+    screen_puts_xy(66, y, 1, "AGE");
+    screen_put_fixed2_1digit(66 + 3*w, y, 1, min(rftiming_stat_mean(&stat) / 10, 9999));
+
+    // stx jitter histogram, scaled to the highest bin
+    uint16_t peak = 1;
+    rftiming_get_histogram(histogram);
+    for (i = 0; i < RFTIMING_HISTOGRAM_BINS; i++) {
+        peak = max(peak, histogram[i]);
+    }
+    for (i = 0; i < RFTIMING_HISTOGRAM_BINS; i++) {
+        uint32_t bar = (histogram[i] * 22) / peak;
+        screen_fill_rect(70 + 3*i, 48 - bar, 2, bar, 1);
+    }
+    screen_draw_hline(68, 48, 52, 1);
+
+    // render buttons and set callback
+    gui_add_button_smallfont(68, 50, 26, 13, "DUMP", &gui_cb_rftiming_dump);
+    gui_add_button_smallfont(98, 50, 26, 13, "RST",  &gui_cb_rftiming_reset);
+}
+
+static void gui_cb_linkstats_dump(void) {
+    linkstats_dump();
+}
+
+static void gui_cb_linkstats_reset(void) {
+    linkstats_reset();
+}
+
+static void gui_render_linkstats(void) {
+    uint32_t h, w;
+    uint32_t i;
+    uint32_t percent, bar;
+    uint32_t worst = FRSKY_HOPTABLE_SIZE;
+    uint32_t worst_percent = 101;
+    linkstats_hop_t stat;
+
+    screen_set_font(&font_tomthumb3x5, &h, &w);
+    screen_puts_xy(17, 1, 1, "HOP RX%");
+
+    // received telemetry packets in the window, one bar per hop index
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        linkstats_get_hop(i, &stat);
+        if (stat.slots == 0) {
+            continue;
+        }
+        percent = linkstats_window_percent(&stat);
+        bar = (percent * GUI_LINKSTATS_BAR_H) / 100;
+        if (bar) {
+            screen_fill_rect(17 + 2*i, GUI_LINKSTATS_BASE_Y - bar, 1, bar, 1);
+        }
+
+        if (percent < worst_percent) {
+            worst_percent = percent;
+            worst = i;
+        }
+    }
+    screen_draw_hline(16, GUI_LINKSTATS_BASE_Y, 2 * FRSKY_HOPTABLE_SIZE + 1, 1);
+
+    // the worst hop index and its quality
+    if (worst < FRSKY_HOPTABLE_SIZE) {
+        screen_puts_xy(66, 1, 1, "MIN");
+        screen_put_uint8(66 + 4*w, 1, 1, worst);
+        screen_put_uint8(66 + 8*w, 1, 1, worst_percent);
+        // mark it below the axis
+        screen_fill_rect(17 + 2*worst, GUI_LINKSTATS_BASE_Y + 2, 1, 2, 1);
+    }
+
+    // render buttons and set callback
+    gui_add_button_smallfont(30, 50, 26, 13, "DUMP", &gui_cb_linkstats_dump);
+    gui_add_button_smallfont(70, 50, 26, 13, "RST",  &gui_cb_linkstats_reset);
+}
+
+
 static void gui_config_render(void) {
     // start with an empty page
     screen_fill(0);
@@ -734,7 +956,7 @@ static void gui_config_header_render(char *str) {
     screen_fill_rect(0, 0, LCD_WIDTH, 7, 1);
     screen_draw_round_rect(0, 0, LCD_WIDTH, LCD_HEIGHT, 3, 1);
 
-    screen_set_font(font_tomthumb3x5, &h, 0);
+    screen_set_font(&font_tomthumb3x5, &h, 0);
     screen_puts_centered(h/2, 0, str);
 }
 
@@ -746,29 +968,30 @@ static void gui_render_main_screen(void) {
     gui_render_statusbar();
     gui_render_bottombar();
 
-    // render voltage
-    screen_set_font(font_metric7x12, &h, &w);
+    // render voltage. font_metric7x12 is a subset, only digits,
+    // " .-AHMV" are compiled in (see the font_compiled.h rule in the Makefile)
+    screen_set_font(&font_metric7x12, &h, &w);
     x = 1;
     y = 10;
-    screen_put_fixed2_1digit(x, y, 1, telemetry_get_voltage());
+    screen_put_fixed2_1digit(x, y, 1, telemetry_get_value(TELEMETRY_SENSOR_VOLTAGE));
     x += w*3 + 3;
     screen_puts_xy(x, y, 1, "V");
 
     x = 1;
     y += h;
-    screen_put_fixed2_1digit(x, y, 1, telemetry_get_current());
+    screen_put_fixed2_1digit(x, y, 1, telemetry_get_value(TELEMETRY_SENSOR_CURRENT));
     x += w*3 + 3;
     screen_puts_xy(x, y, 1, "A");
 
-    x = LCD_WIDTH - (font_metric7x12[FONT_FIXED_WIDTH]+1)*7 - 1;
+    x = LCD_WIDTH - (font_metric7x12.width+1)*7 - 1;
     y += h;
     y += 5;
-    screen_put_uint14(x, y, 1, telemetry_get_mah());
+    screen_put_uint14(x, y, 1, telemetry_get_value(TELEMETRY_SENSOR_FUEL));
     x += w*4 + 1;
     screen_puts_xy(x, y, 1, "MAH");
 
-    // screen_set_font(font_metric7x12);
-    screen_set_font(font_metric15x26, &h, &w);
+    // screen_set_font(&font_metric7x12);
+    screen_set_font(&font_metric15x26, &h, &w);
 
     // render time
     uint32_t color = 1;
@@ -802,7 +1025,7 @@ static void gui_render_main_screen(void) {
 
 
 static void gui_config_main_render(void) {
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
 
     // header
     gui_config_header_render("MAIN CONFIGURATION");
@@ -817,7 +1040,7 @@ static void gui_config_main_render(void) {
 
 
 static void gui_setup_main_render(void) {
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
 
     // header
     gui_config_header_render("SETUP");
@@ -834,7 +1057,7 @@ static void gui_setup_main_render(void) {
 static void gui_render_usb(void) {
     screen_fill(0);
 
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
 
     // header
     gui_config_header_render("USB JOYSTICK MODE");
@@ -862,12 +1085,14 @@ static void gui_render_usb(void) {
 }
 
 static void gui_setup_bootloader_render(void) {
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
 
     // header
     gui_config_header_render("BOOTLOADER MODE");
     screen_puts_xy(3, 9, 1, "WILL ENTER BOOTLOADER NOW!");
     screen_update();
+    // the transfer has to finish before we jump
+    lcd_wait();
 
     // Our STM32 F072 has:
     // 16k SRAM in address 0x2000 0000 - 0x2000 3FFF
@@ -879,9 +1104,10 @@ static void gui_setup_bootloader_render(void) {
 
 static void gui_setup_clonetx_render(void) {
     uint32_t w, h;
+    uint32_t slice_start;
 
     // set font
-    screen_set_font(font_tomthumb3x5, &h, &w);
+    screen_set_font(&font_tomthumb3x5, &h, &w);
 
     // header
     gui_config_header_render("CLONE TX");
@@ -890,7 +1116,11 @@ static void gui_setup_clonetx_render(void) {
     screen_puts_xy(3, 9 + 1*h, 1, "preparing bind...");
 
     if (gui_config_counter >= 1) screen_puts_xy(3, 9 + 2*h, 1, "preparing autotune");
-    if (gui_config_counter >= 2) screen_puts_xy(3, 9 + 3*h, 1, "autotune running (takes long)");
+    if (gui_config_counter >= 2) {
+        screen_puts_xy(3, 9 + 3*h, 1, "autotune running");
+        screen_put_uint8(3+w*17, 9 + 3*h, 1, frsky_autotune_get_progress());
+        screen_puts_xy(3+w*20, 9 + 3*h, 1, "%");
+    }
     if (gui_config_counter >= 3) {
         screen_puts_xy(3, 9 + 4*h, 1, "autotune done. freq offset 0x");
         screen_put_hex16(3+w*29, 9 + 4*h, 1, storage.frsky_freq_offset);
@@ -918,17 +1148,21 @@ static void gui_setup_clonetx_render(void) {
             break;
 
         case (2) :
-            // do autotune loop until done
-            while (!frsky_autotune_do()) {
-                // screen_fill(0); console_render(); screen_update();
-                if (io_powerbutton_pressed()) {
-                    // abort! reenable tx code
-                    frsky_tx_set_enabled(0);
-                    gui_page = GUI_PAGE_SETUP_MAIN;
-                    return;
+            if (io_powerbutton_pressed()) {
+                // abort! reenable tx code
+                frsky_tx_set_enabled(0);
+                gui_page = GUI_PAGE_SETUP_MAIN;
+                return;
+            }
+            // run the autotune for a part of this gui iteration only,
+            // the remaining time is used to render the progress
+            slice_start = rftiming_now();
+            while ((rftiming_now() - slice_start) < GUI_AUTOTUNE_SLICE_US) {
+                if (frsky_autotune_do()) {
+                    gui_config_counter++;
+                    break;
                 }
             }
-            gui_config_counter++;
             break;
 
         case (3) :
@@ -974,7 +1208,7 @@ static void gui_setup_clonetx_render(void) {
 
 static void gui_setup_bindmode_render(void) {
     uint32_t h;
-    screen_set_font(font_tomthumb3x5, &h, 0);
+    screen_set_font(&font_tomthumb3x5, &h, 0);
 
     // header
     gui_config_header_render("BIND");
@@ -999,7 +1233,7 @@ static void gui_setup_bindmode_render(void) {
 
 static void gui_config_model_render_main(void) {
     uint32_t h;
-    screen_set_font(font_system5x7, &h, 0);
+    screen_set_font(&font_system5x7, &h, 0);
 
     uint32_t y = 12;
 
@@ -1024,10 +1258,17 @@ static void gui_config_model_render_main(void) {
 
     // add stick scaling
     gui_add_button_smallfont(3, y, 40, 13, "SCALE", &gui_cb_setting_model_stickscale);
+
+    // protocol
+    gui_add_button_smallfont(46, y, 40, 13, "PROTO", &gui_cb_setting_model_protocol);
     y += 13 + 1;
 
     // time
     gui_add_button_smallfont(3, y, 40, 13, "TIMER", &gui_cb_setting_model_timer);
+    y += 13 + 1;
+
+    // rf schedule / telemetry rate
+    gui_add_button_smallfont(3, y, 40, 13, "TELEM", &gui_cb_setting_model_schedule);
 
     // render buttons and set callback
     gui_add_button_smallfont(89, 34 + 0*15, 35, 13, "SAVE", &gui_cb_config_save);
@@ -1051,7 +1292,7 @@ static void gui_render_option_window(char *opt_name, f_ptr_32_32_t func) {
     y += 5;
 
     // font selection
-    screen_set_font(font_system5x7, &h, 0);
+    screen_set_font(&font_system5x7, &h, 0);
 
     // render text
     screen_puts_centered(y, 1, opt_name);
@@ -1066,13 +1307,13 @@ static void gui_render_option_window(char *opt_name, f_ptr_32_32_t func) {
     }
 
     // add buttons
-    screen_set_font(font_tomthumb3x5, 0, 0);
+    screen_set_font(&font_tomthumb3x5, 0, 0);
     y = LCD_HEIGHT - (LCD_HEIGHT - window_h) / 2 - 16;
     gui_add_button_smallfont((LCD_WIDTH - 40) / 2, y, 40, 13, "OK", &gui_cb_setting_option_leave);
 }
 
 static void gui_cb_render_option_stickscale(uint32_t UNUSED(x), uint32_t y) {
-    screen_set_font(font_system5x7, 0, 0);
+    screen_set_font(&font_system5x7, 0, 0);
 
     // render +/- button
     gui_add_button(15, y, 15, 15, "-", &gui_cb_model_stickscale_dec);
@@ -1084,7 +1325,7 @@ static void gui_cb_render_option_stickscale(uint32_t UNUSED(x), uint32_t y) {
 }
 
 static void gui_cb_render_option_timer(uint32_t UNUSED(x), uint32_t y) {
-    screen_set_font(font_system5x7, 0, 0);
+    screen_set_font(&font_system5x7, 0, 0);
 
     // render +/- button
     gui_add_button(15, y, 15, 15, "-", &gui_cb_model_timer_dec);
@@ -1095,6 +1336,30 @@ static void gui_cb_render_option_timer(uint32_t UNUSED(x), uint32_t y) {
                      y, 1, storage.model[storage.current_model].timer);
 }
 
+static void gui_cb_render_option_schedule(uint32_t UNUSED(x), uint32_t y) {
+    screen_set_font(&font_system5x7, 0, 0);
+
+    // render +/- button
+    gui_add_button(15, y, 15, 15, "-", &gui_cb_model_schedule_dec);
+    gui_add_button(LCD_WIDTH - 15 - 15, y, 15, 15, "+", &gui_cb_model_schedule_inc);
+
+    // render schedule name
+    screen_puts_centered(y + 4, 1,
+                         frsky_get_schedule_name(storage.model[storage.current_model].rf_schedule));
+}
+
+static void gui_cb_render_option_protocol(uint32_t UNUSED(x), uint32_t y) {
+    screen_set_font(&font_system5x7, 0, 0);
+
+    // render +/- button
+    gui_add_button(15, y, 15, 15, "-", &gui_cb_model_protocol_dec);
+    gui_add_button(LCD_WIDTH - 15 - 15, y, 15, 15, "+", &gui_cb_model_protocol_inc);
+
+    // render protocol name
+    screen_puts_centered(y + 4, 1,
+                         frsky_get_protocol_name(storage.model[storage.current_model].protocol));
+}
+
 
 static void gui_config_model_render(void) {
     // header
@@ -1123,6 +1388,14 @@ static void gui_config_model_render(void) {
             case (GUI_SUBPAGE_SETTING_MODEL_TIMER) :
                 gui_render_option_window("TIMER", &gui_cb_render_option_timer);
                 break;
+
+            case (GUI_SUBPAGE_SETTING_MODEL_SCHEDULE) :
+                gui_render_option_window("TELEMETRY", &gui_cb_render_option_schedule);
+                break;
+
+            case (GUI_SUBPAGE_SETTING_MODEL_PROTOCOL) :
+                gui_render_option_window("PROTOCOL", &gui_cb_render_option_protocol);
+                break;
         }
     }
 }
@@ -1133,7 +1406,7 @@ static void gui_config_stick_calibration_render(void) {
     uint32_t i;
     uint32_t a;
 
-    screen_set_font(font_tomthumb3x5, &h, &w);
+    screen_set_font(&font_tomthumb3x5, &h, &w);
 
     // store adc values
     gui_config_stick_calibration_store_adc_values();
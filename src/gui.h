@@ -28,12 +28,21 @@
 #define GUI_PAGE_MAIN     0
 #define GUI_PAGE_STICKS   1
 #define GUI_PAGE_SETTINGS 2
-#define GUI_MAX_PAGE GUI_PAGE_SETTINGS
-#define GUI_STATUSBAR_FONT font_tomthumb3x5
+#define GUI_PAGE_RFTIMING 3
+#define GUI_PAGE_LINKSTATS 4
+#define GUI_MAX_PAGE GUI_PAGE_LINKSTATS
+#define GUI_STATUSBAR_FONT (&font_tomthumb3x5)
+// link statistics bars
+#define GUI_LINKSTATS_BASE_Y 44
+#define GUI_LINKSTATS_BAR_H  34
 
 
 #define GUI_LOOP_DELAY_MS 100
 #define GUI_SHUTDOWN_PRESS_S 2.0
+// time per gui iteration given to the autotune
+#define GUI_AUTOTUNE_SLICE_US 60000
+// beep once per second while the lowest cell is below this (0.01V)
+#define GUI_ALARM_CELL_VOLTAGE 330
 #define GUI_SHUTDOWN_PRESS_COUNT_FROM_MS(_ms) ((_ms)/GUI_LOOP_DELAY_MS)
 #define GUI_SHUTDOWN_PRESS_COUNT (GUI_SHUTDOWN_PRESS_COUNT_FROM_MS(1000*GUI_SHUTDOWN_PRESS_S))
 
@@ -74,6 +83,8 @@ typedef struct {
 #define GUI_SUBPAGE_SETTING_MODEL_NAME  0
 #define GUI_SUBPAGE_SETTING_MODEL_SCALE 1
 #define GUI_SUBPAGE_SETTING_MODEL_TIMER 2
+#define GUI_SUBPAGE_SETTING_MODEL_SCHEDULE 3
+#define GUI_SUBPAGE_SETTING_MODEL_PROTOCOL 4
 
 void gui_init(void);
 void gui_loop(void);
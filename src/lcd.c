@@ -31,18 +31,44 @@
 #include <libopencm3/stm32/timer.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/stm32/syscfg.h>
+#include <libopencm3/cm3/nvic.h>
+#include <libopencm3/cm3/cortex.h>
+#include <string.h>
+
+// the ram is 132 columns wide, the visible area starts at column 4
+#define LCD_COLUMN_OFFSET 4
 
 // INTERNAL FUNCTIONS
 static void lcd_init_gpio(void);
 static void lcd_init_rcc(void);
 static void lcd_reset(void);
 static void lcd_write_command(uint8_t data);
+static void lcd_init_dma(void);
+static void lcd_set_address(uint32_t page, uint32_t col);
+static void lcd_dma_start(uint32_t page);
+static void lcd_dma_next(void);
+static void lcd_dma_service(void);
+
+// copy of the lcd ram, used to skip unchanged columns
+static uint8_t lcd_shadow[LCD_PAGES * LCD_WIDTH];
+
+// windows of the frame that is being transferred
+static lcd_window_t lcd_dma_window[LCD_PAGES];
+static const uint8_t *lcd_dma_buf;
+static uint8_t lcd_dma_page;
+static volatile uint8_t lcd_dma_busy;
+
+// written to the rd gpio bsrr: rd high, rd low
+static const uint32_t lcd_dma_strobe[2] = { LCD_RD_PIN, LCD_RD_PIN << 16 };
 
 
 void lcd_init(void) {
     lcd_init_rcc();
     lcd_init_gpio();
     lcd_reset();
+    lcd_init_dma();
 }
 
 static void lcd_init_rcc(void) {
@@ -53,6 +79,11 @@ static void lcd_init_rcc(void) {
     rcc_periph_clock_enable(GPIO_RCC(LCD_RS_GPIO));
     rcc_periph_clock_enable(GPIO_RCC(LCD_RD_GPIO));
     rcc_periph_clock_enable(GPIO_RCC(LCD_CS_GPIO));
+    // dma engine
+    rcc_periph_clock_enable(RCC_DMA1);
+    rcc_periph_clock_enable(RCC_TIM16);
+    rcc_periph_clock_enable(RCC_TIM17);
+    rcc_periph_clock_enable(RCC_SYSCFG_COMP);
 }
 
 static void lcd_init_gpio(void) {
@@ -107,7 +138,66 @@ static void lcd_write_command(uint8_t data) {
 }
 
 
+static void lcd_init_dma(void) {
+    // move the timer requests away from the adc and spi channels
+    SYSCFG_CFGR1 |= SYSCFG_CFGR1_TIM16_DMA_RMP | SYSCFG_CFGR1_TIM17_DMA_RMP2;
+
+    // data: one byte per TIM16 cc1 match to the lower byte of the data gpio
+    dma_channel_reset(DMA1, LCD_DMA_DATA_CHANNEL);
+    dma_set_peripheral_address(DMA1, LCD_DMA_DATA_CHANNEL, (uint32_t)&GPIO_ODR(LCD_DATA_GPIO));
+    dma_set_read_from_memory(DMA1, LCD_DMA_DATA_CHANNEL);
+    dma_enable_memory_increment_mode(DMA1, LCD_DMA_DATA_CHANNEL);
+    dma_set_peripheral_size(DMA1, LCD_DMA_DATA_CHANNEL, DMA_CCR_PSIZE_8BIT);
+    dma_set_memory_size(DMA1, LCD_DMA_DATA_CHANNEL, DMA_CCR_MSIZE_8BIT);
+    dma_set_priority(DMA1, LCD_DMA_DATA_CHANNEL, DMA_CCR_PL_LOW);
+
+    // strobe: rd high/low per TIM17 cc1 match
+    dma_channel_reset(DMA1, LCD_DMA_STROBE_CHANNEL);
+    dma_set_peripheral_address(DMA1, LCD_DMA_STROBE_CHANNEL, (uint32_t)&GPIO_BSRR(LCD_RD_GPIO));
+    dma_set_memory_address(DMA1, LCD_DMA_STROBE_CHANNEL, (uint32_t)lcd_dma_strobe);
+    dma_set_read_from_memory(DMA1, LCD_DMA_STROBE_CHANNEL);
+    dma_enable_memory_increment_mode(DMA1, LCD_DMA_STROBE_CHANNEL);
+    dma_enable_circular_mode(DMA1, LCD_DMA_STROBE_CHANNEL);
+    dma_set_peripheral_size(DMA1, LCD_DMA_STROBE_CHANNEL, DMA_CCR_PSIZE_32BIT);
+    dma_set_memory_size(DMA1, LCD_DMA_STROBE_CHANNEL, DMA_CCR_MSIZE_32BIT);
+    // the strobe has to win against the data byte of the same cycle
+    dma_set_priority(DMA1, LCD_DMA_STROBE_CHANNEL, DMA_CCR_PL_MEDIUM);
+
+    // TIM16 paces the data bytes, TIM17 runs at twice the rate for
+    // the strobes. both run in one pulse mode, the repetition counter
+    // is set to the window length, this way both stop on their own
+    // after the last byte no matter how late the irq is served
+    timer_reset(TIM16);
+    timer_set_mode(TIM16, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
+    timer_set_prescaler(TIM16, 0);
+    timer_set_period(TIM16, LCD_DMA_BYTE_TICKS - 1);
+    timer_one_shot_mode(TIM16);
+    timer_update_on_overflow(TIM16);
+    timer_set_oc_mode(TIM16, TIM_OC1, TIM_OCM_FROZEN);
+    timer_set_oc_value(TIM16, TIM_OC1, LCD_DMA_DATA_OC);
+    timer_enable_irq(TIM16, TIM_DIER_CC1DE);
+
+    timer_reset(TIM17);
+    timer_set_mode(TIM17, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
+    timer_set_prescaler(TIM17, 0);
+    timer_set_period(TIM17, (LCD_DMA_BYTE_TICKS / 2) - 1);
+    timer_one_shot_mode(TIM17);
+    timer_update_on_overflow(TIM17);
+    timer_set_oc_mode(TIM17, TIM_OC1, TIM_OCM_FROZEN);
+    timer_set_oc_value(TIM17, TIM_OC1, LCD_DMA_STROBE_OC);
+    // the final update event marks the end of the window
+    timer_enable_irq(TIM17, TIM_DIER_CC1DE | TIM_DIER_UIE);
+
+    lcd_dma_busy = 0;
+
+    nvic_set_priority(LCD_DMA_IRQ, NVIC_PRIO_LCD);
+    nvic_enable_irq(LCD_DMA_IRQ);
+}
+
 void lcd_powerdown(void) {
+    // finish the current transfer
+    lcd_wait();
+
     // switch display off
     lcd_write_command(LCD_CMD_DISPLAY_OFF);
 
@@ -173,48 +263,173 @@ static void lcd_reset(void) {
     lcd_write_command(LCD_CMD_DISPLAY_ON);
 }
 
-void lcd_send_data(const uint8_t *buf) {
-    uint32_t x, y;
+static void lcd_set_address(uint32_t page, uint32_t col) {
+    lcd_write_command(LCD_CMD_SET_COL_LO + (col & 0x0F));
+    lcd_write_command(LCD_CMD_SET_COL_HI + (col >> 4));
+    lcd_write_command(LCD_CMD_SET_PAGESTART + page);
+}
 
-    // set start to 0,0
-    lcd_write_command(LCD_CMD_SET_STARTLINE + 0);
-    lcd_write_command(LCD_CMD_SET_PAGESTART + 2);
+// one data window per page, started by lcd_dma_next() and
+// finished by the TIM17 irq
+static void lcd_dma_start(uint32_t page) {
+    const uint8_t *src = &lcd_dma_buf[page * LCD_WIDTH + lcd_dma_window[page].x0];
+    uint32_t len = lcd_dma_window[page].x1 - lcd_dma_window[page].x0 + 1;
+    uint32_t mask;
 
-    // set col address of ram to 0
-    lcd_write_command(LCD_CMD_SET_COL_LO + 0);
-    lcd_write_command(LCD_CMD_SET_COL_HI + 0);
+    lcd_set_address(page, LCD_COLUMN_OFFSET + lcd_dma_window[page].x0);
 
-    for (y = 0; y < 8; y++) {
-        // start on col 0
-        lcd_write_command(LCD_CMD_SET_COL_LO + 0);
-        lcd_write_command(LCD_CMD_SET_COL_HI + 0);
-        // page start
-        lcd_write_command(LCD_CMD_SET_PAGESTART + y);
-
-        LCD_CS_LO();
-        LCD_RS_HI();
-        LCD_RW_LO();
-
-        // send 4 dummy bytes(132-128)
-        for (x = 4; x > 0; --x) {
-            LCD_DATA_SET(0x00);
-            LCD_RD_HI();
-            LCD_RD_LO();
-        }
+    // data mode, the cpu puts the first byte on the bus
+    LCD_CS_LO();
+    LCD_RS_HI();
+    LCD_RW_LO();
+    LCD_DATA_SET(src[0]);
+
+    // two strobe writes per byte
+    dma_disable_channel(DMA1, LCD_DMA_STROBE_CHANNEL);
+    dma_set_number_of_data(DMA1, LCD_DMA_STROBE_CHANNEL, 2);
+    dma_enable_channel(DMA1, LCD_DMA_STROBE_CHANNEL);
+    timer_set_repetition_counter(TIM17, 2 * len - 1);
+    // load the repetition counter, no irq as URS is set
+    timer_generate_event(TIM17, TIM_EGR_UG);
+
+    // the remaining bytes
+    if (len > 1) {
+        dma_disable_channel(DMA1, LCD_DMA_DATA_CHANNEL);
+        dma_set_memory_address(DMA1, LCD_DMA_DATA_CHANNEL, (uint32_t)&src[1]);
+        dma_set_number_of_data(DMA1, LCD_DMA_DATA_CHANNEL, len - 1);
+        dma_enable_channel(DMA1, LCD_DMA_DATA_CHANNEL);
+        timer_set_repetition_counter(TIM16, len - 2);
+        timer_generate_event(TIM16, TIM_EGR_UG);
+    }
+
+    // both timers have to start in the same cycle
+    mask = cm_mask_interrupts(1);
+    timer_enable_counter(TIM17);
+    if (len > 1) {
+        timer_enable_counter(TIM16);
+    }
+    cm_mask_interrupts(mask);
+}
+
+static void lcd_dma_next(void) {
+    uint32_t page;
 
-        for (x = 128; x > 0; --x) {
-            LCD_DATA_SET(*buf++);
-            // execute write
-            LCD_RD_HI();
-            LCD_RD_LO();
+    while (lcd_dma_page < LCD_PAGES) {
+        page = lcd_dma_page++;
+        if (lcd_dma_window[page].x0 <= lcd_dma_window[page].x1) {
+            lcd_dma_start(page);
+            return;
         }
     }
 
-    LCD_RD_HI();
+    // frame done
+    lcd_dma_busy = 0;
+}
+
+static void lcd_dma_service(void) {
+    if (!timer_get_flag(TIM17, TIM_SR_UIF)) {
+        return;
+    }
+    timer_clear_flag(TIM17, TIM_SR_UIF);
+
+    // the last strobe is done, both timers stopped themselves
+    dma_disable_channel(DMA1, LCD_DMA_DATA_CHANNEL);
+    dma_disable_channel(DMA1, LCD_DMA_STROBE_CHANNEL);
 
     // deselect device
     LCD_CS_HI();
     LCD_RW_HI();
+
+    lcd_dma_next();
+}
+
+void TIM17_IRQHandler(void) {
+    lcd_dma_service();
+}
+
+uint8_t lcd_busy(void) {
+    return lcd_dma_busy;
+}
+
+// wait for the current frame. polls the engine as well, this way
+// it is safe to call this from an isr that blocks the lcd irq
+void lcd_wait(void) {
+    while (lcd_dma_busy) {
+        nvic_disable_irq(LCD_DMA_IRQ);
+        lcd_dma_service();
+        nvic_enable_irq(LCD_DMA_IRQ);
+    }
+}
+
+// display row 0 shows this ram row, used for hardware scrolling
+void lcd_set_startline(uint8_t line) {
+    // make sure the pending data is shown with the new start line
+    lcd_wait();
+    lcd_write_command(LCD_CMD_SET_STARTLINE + (line % LCD_HEIGHT));
+}
+
+// transfer a full frame in the background
+void lcd_send_data(const uint8_t *buf) {
+    uint32_t y;
+
+    lcd_wait();
+
+    // set startline to 0
+    lcd_write_command(LCD_CMD_SET_STARTLINE + 0);
+
+    for (y = 0; y < LCD_PAGES; y++) {
+        lcd_dma_window[y].x0 = 0;
+        lcd_dma_window[y].x1 = LCD_WIDTH - 1;
+    }
+
+    // lcd ram will hold the full frame
+    memcpy(lcd_shadow, buf, sizeof(lcd_shadow));
+
+    lcd_dma_buf = buf;
+    lcd_dma_page = 0;
+    lcd_dma_busy = 1;
+    lcd_dma_next();
+}
+
+// transfer the changed part of the given windows in the background.
+// buf has to stay untouched until lcd_busy() returns 0
+void lcd_send_windows(const uint8_t *buf, const lcd_window_t *window) {
+    uint32_t y;
+    uint32_t x0, x1;
+    const uint8_t *src;
+    uint8_t *dst;
+
+    lcd_wait();
+
+    for (y = 0; y < LCD_PAGES; y++) {
+        x0 = window[y].x0;
+        x1 = window[y].x1;
+        if (x1 >= LCD_WIDTH) {
+            x1 = LCD_WIDTH - 1;
+        }
+
+        // drop columns that already hold the same data
+        src = &buf[y * LCD_WIDTH];
+        dst = &lcd_shadow[y * LCD_WIDTH];
+        while ((x0 <= x1) && (src[x0] == dst[x0])) {
+            x0++;
+        }
+        while ((x1 > x0) && (src[x1] == dst[x1])) {
+            x1--;
+        }
+        if (x0 <= x1) {
+            memcpy(&dst[x0], &src[x0], x1 - x0 + 1);
+        }
+
+        // x0 > x1 skips the page
+        lcd_dma_window[y].x0 = x0;
+        lcd_dma_window[y].x1 = x1;
+    }
+
+    lcd_dma_buf = buf;
+    lcd_dma_page = 0;
+    lcd_dma_busy = 1;
+    lcd_dma_next();
 }
 
 void lcd_show_logo(void) {
@@ -27,9 +27,20 @@
 // the screen itself is 128 x 64
 #define LCD_WIDTH   128
 #define LCD_HEIGHT   64
+#define LCD_PAGES    (LCD_HEIGHT / 8)
+
+// changed column range of one lcd page, x0 > x1 marks an unchanged page
+typedef struct {
+    uint8_t x0;
+    uint8_t x1;
+} lcd_window_t;
 
 void lcd_init(void);
 void lcd_send_data(const uint8_t *buf);
+void lcd_send_windows(const uint8_t *buf, const lcd_window_t *window);
+uint8_t lcd_busy(void);
+void lcd_wait(void);
+void lcd_set_startline(uint8_t line);
 void lcd_powerdown(void);
 void lcd_show_logo(void);
 
@@ -48,6 +59,18 @@ void lcd_show_logo(void);
 #define LCD_CS_HI()   { gpio_set(LCD_CS_GPIO, LCD_CS_PIN); }
 #define LCD_CS_LO()   { gpio_clear(LCD_CS_GPIO, LCD_CS_PIN); }
 
+// timer ticks per byte (48MHz timer clock -> 1.5 MByte/s)
+#define LCD_DMA_BYTE_TICKS   32
+// rd goes high at 1/8 and low at 5/8 of the byte cycle,
+// the next data byte is put on the bus at 13/16
+#define LCD_DMA_STROBE_OC    (LCD_DMA_BYTE_TICKS / 8)
+#define LCD_DMA_DATA_OC      ((LCD_DMA_BYTE_TICKS * 13) / 16)
+
+// not defined by all libopencm3 versions (stm32f07x only)
+#ifndef SYSCFG_CFGR1_TIM17_DMA_RMP2
+#define SYSCFG_CFGR1_TIM17_DMA_RMP2 (1 << 14)
+#endif  // SYSCFG_CFGR1_TIM17_DMA_RMP2
+
 // #define LCD_DATA_SET(data) { GPIO_ODR(LCD_DATA_GPIO)
 // = (GPIO_ODR(LCD_DATA_GPIO) & 0xFF00) | (data);}
 
@@ -0,0 +1,162 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+#include "linkstats.h"
+#include "debug.h"
+#include "seqlock.h"
+#include "storage.h"
+
+// one entry per hop table index
+static linkstats_hop_t linkstats_hop[FRSKY_HOPTABLE_SIZE];
+// written by the rf bottom half, read by the gui
+static seqlock_t linkstats_seqlock;
+// set by the gui, the bottom half clears the stats
+static volatile uint8_t linkstats_reset_request;
+
+// internal functions
+static uint8_t linkstats_popcount(uint16_t bits);
+static void linkstats_clear(void);
+
+void linkstats_init(void) {
+    debug("linkstats: init\n"); debug_flush();
+
+    seqlock_init(&linkstats_seqlock);
+    linkstats_reset_request = 0;
+    linkstats_clear();
+}
+
+// the stats are only written from the bottom half, the
+// reset is done there with the next receive slot
+void linkstats_reset(void) {
+    linkstats_reset_request = 1;
+}
+
+static void linkstats_clear(void) {
+    uint32_t i;
+
+    seqlock_write_begin(&linkstats_seqlock);
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        linkstats_hop[i].history  = 0;
+        linkstats_hop[i].slots    = 0;
+        linkstats_hop[i].rssi     = 0;
+        linkstats_hop[i].lqi      = 0;
+        linkstats_hop[i].received = 0;
+        linkstats_hop[i].missed   = 0;
+    }
+    seqlock_write_end(&linkstats_seqlock);
+}
+
+// called by the bottom half once per telemetry receive slot
+void linkstats_rx(uint8_t hop, uint8_t valid, uint8_t rssi, uint8_t lqi) {
+    linkstats_hop_t *stat;
+    int32_t value;
+
+    if (linkstats_reset_request) {
+        linkstats_reset_request = 0;
+        linkstats_clear();
+    }
+
+    if (hop >= FRSKY_HOPTABLE_SIZE) {
+        return;
+    }
+    stat = &linkstats_hop[hop];
+
+    seqlock_write_begin(&linkstats_seqlock);
+
+    stat->history = (stat->history << 1) | (valid ? 1 : 0);
+    if (stat->slots < LINKSTATS_WINDOW) {
+        stat->slots++;
+    }
+
+    if (valid) {
+        if (stat->received == 0) {
+            // start the averages with the first packet
+            stat->rssi = rssi << LINKSTATS_FP_SHIFT;
+            stat->lqi  = lqi << LINKSTATS_FP_SHIFT;
+        } else {
+            value = (rssi << LINKSTATS_FP_SHIFT) - stat->rssi;
+            stat->rssi += value >> LINKSTATS_EWMA_SHIFT;
+            value = (lqi << LINKSTATS_FP_SHIFT) - stat->lqi;
+            stat->lqi  += value >> LINKSTATS_EWMA_SHIFT;
+        }
+        if (stat->received != 0xFFFF) {
+            stat->received++;
+        }
+    } else if (stat->missed != 0xFFFF) {
+        stat->missed++;
+    }
+
+    seqlock_write_end(&linkstats_seqlock);
+}
+
+void linkstats_get_hop(uint8_t hop, linkstats_hop_t *stat) {
+    uint32_t sequence;
+
+    do {
+        sequence = seqlock_read_begin(&linkstats_seqlock);
+        *stat = linkstats_hop[hop];
+    } while (seqlock_read_retry(&linkstats_seqlock, sequence));
+}
+
+static uint8_t linkstats_popcount(uint16_t bits) {
+    uint8_t count = 0;
+
+    while (bits) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+}
+
+// received packets within the window in percent
+uint8_t linkstats_window_percent(linkstats_hop_t *stat) {
+    uint16_t mask = (1 << stat->slots) - 1;
+
+    if (stat->slots == 0) {
+        return 0;
+    }
+    return (linkstats_popcount(stat->history & mask) * 100) / stat->slots;
+}
+
+void linkstats_dump(void) {
+    linkstats_hop_t stat;
+    uint32_t i;
+
+    debug("linkstats: hop ch rx% rssi lqi rx miss\n");
+    for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
+        linkstats_get_hop(i, &stat);
+        if (stat.slots == 0) {
+            continue;
+        }
+        debug_put_uint8(i);
+        debug(" ");
+        debug_put_hex8(storage.frsky_hop_table[i]);
+        debug(" ");
+        debug_put_uint8(linkstats_window_percent(&stat));
+        debug(" ");
+        debug_put_uint8(stat.rssi >> LINKSTATS_FP_SHIFT);
+        debug(" ");
+        debug_put_uint8(stat.lqi >> LINKSTATS_FP_SHIFT);
+        debug(" ");
+        debug_put_uint16(stat.received);
+        debug(" ");
+        debug_put_uint16(stat.missed);
+        debug_put_newline();
+        debug_flush();
+    }
+}
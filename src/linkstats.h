@@ -0,0 +1,51 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+#ifndef LINKSTATS_H_
+#define LINKSTATS_H_
+
+#include <stdint.h>
+#include "frsky.h"
+
+// receive slots per hop kept in the sliding window (bits of history)
+#define LINKSTATS_WINDOW 16
+// rssi/lqi averages: avg += (new - avg) >> SHIFT, stored << FP_SHIFT
+#define LINKSTATS_EWMA_SHIFT 3
+#define LINKSTATS_FP_SHIFT   4
+
+typedef struct {
+    // bit 0 = newest receive slot on this hop, 1 = valid packet
+    uint16_t history;
+    // valid bits in history
+    uint8_t slots;
+    // averages of valid packets, << LINKSTATS_FP_SHIFT
+    uint16_t rssi;
+    uint16_t lqi;
+    // totals since the last reset, saturating
+    uint16_t received;
+    uint16_t missed;
+} linkstats_hop_t;
+
+void linkstats_init(void);
+void linkstats_reset(void);
+void linkstats_rx(uint8_t hop, uint8_t valid, uint8_t rssi, uint8_t lqi);
+void linkstats_get_hop(uint8_t hop, linkstats_hop_t *stat);
+uint8_t linkstats_window_percent(linkstats_hop_t *stat);
+void linkstats_dump(void);
+
+#endif  // LINKSTATS_H_
@@ -0,0 +1,261 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+#include "lswitch.h"
+#include "debug.h"
+#include "macros.h"
+#include "config.h"
+#include <string.h>
+#include <libopencm3/cm3/nvic.h>
+
+// the adc isr evaluates the active program, lswitch_compile() builds
+// the other one and switches over once it is complete
+static lswitch_program_t lswitch_program[2];
+static lswitch_program_t * volatile lswitch_active;
+
+// evaluation state, only touched by lswitch_process()
+static const lswitch_program_t *lswitch_evaluated;
+static int16_t lswitch_input_last[CHANNEL_ID_SIZE];
+static lswitch_state_t lswitch_prev_a;
+static lswitch_state_t lswitch_prev_b;
+static lswitch_state_t lswitch_pulse;
+
+// published results
+static volatile lswitch_state_t lswitch_state;
+static volatile lswitch_state_t lswitch_changes;
+
+// internal functions
+static uint32_t lswitch_source_valid(uint8_t src, uint32_t index);
+static void lswitch_add_dependency(lswitch_program_t *prog, uint8_t src, uint32_t index);
+static uint32_t lswitch_source(const int16_t *rescaled, lswitch_state_t state, uint8_t src);
+
+void lswitch_init(void) {
+    debug("lswitch: init\n"); debug_flush();
+
+    // no switches until the model is compiled by storage_load()
+    lswitch_program[0].count = 0;
+    lswitch_evaluated = 0;
+    lswitch_state = 0;
+    lswitch_changes = 0;
+    lswitch_active = &lswitch_program[0];
+}
+
+// channels, or switches evaluated before this one
+static uint32_t lswitch_source_valid(uint8_t src, uint32_t index) {
+    if (src & STORAGE_LSWITCH_SRC_SWITCH) {
+        return (src & ~STORAGE_LSWITCH_SRC_SWITCH) < index;
+    }
+    return src < CHANNEL_ID_SIZE;
+}
+
+static void lswitch_add_dependency(lswitch_program_t *prog, uint8_t src, uint32_t index) {
+    if (src & STORAGE_LSWITCH_SRC_SWITCH) {
+        prog->depends_switch[src & ~STORAGE_LSWITCH_SRC_SWITCH] |= (1 << index);
+    } else {
+        prog->depends_channel[src] |= (1 << index);
+    }
+}
+
+void lswitch_compile(void) {
+    MODEL_DESC *model = &storage.model[storage.current_model];
+    lswitch_program_t *prog;
+    LSWITCH_DESC *desc;
+    uint32_t i, valid;
+
+    // build the program that is not in use
+    if (lswitch_active == &lswitch_program[0]) {
+        prog = &lswitch_program[1];
+    } else {
+        prog = &lswitch_program[0];
+    }
+    memset(prog, 0, sizeof(lswitch_program_t));
+
+    for (i = 0; i < STORAGE_LSWITCH_COUNT; i++) {
+        desc = &prog->desc[i];
+        *desc = model->lswitch[i];
+
+        // invalid sources disable the switch. switches can only use
+        // switches with a lower index, this way a single pass in index
+        // order evaluates everything
+        switch (desc->func & STORAGE_LSWITCH_FUNC_MASK) {
+            case (LSWITCH_FUNC_GT):
+            case (LSWITCH_FUNC_LT):
+                valid = (desc->a < CHANNEL_ID_SIZE);
+                break;
+            case (LSWITCH_FUNC_EDGE):
+                valid = lswitch_source_valid(desc->a, i);
+                break;
+            case (LSWITCH_FUNC_LATCH):
+                valid = lswitch_source_valid(desc->a, i) && lswitch_source_valid(desc->b, i);
+                break;
+            default:
+                valid = 0;
+                break;
+        }
+
+        if (!valid) {
+            desc->func = LSWITCH_FUNC_NONE;
+            continue;
+        }
+
+        prog->threshold[i] = (desc->value * ADC_RESCALE_TARGET_RANGE) / 100;
+        lswitch_add_dependency(prog, desc->a, i);
+        if ((desc->func & STORAGE_LSWITCH_FUNC_MASK) == LSWITCH_FUNC_LATCH) {
+            lswitch_add_dependency(prog, desc->b, i);
+        }
+        prog->count = i + 1;
+    }
+
+    // switch over, the next evaluation starts from scratch
+    lswitch_active = prog;
+
+    debug("lswitch: compiled ");
+    debug_put_uint8(prog->count);
+    debug(" switches\n");
+    debug_flush();
+}
+
+static uint32_t lswitch_source(const int16_t *rescaled, lswitch_state_t state, uint8_t src) {
+    if (src & STORAGE_LSWITCH_SRC_SWITCH) {
+        return (state >> (src & ~STORAGE_LSWITCH_SRC_SWITCH)) & 1;
+    }
+    return rescaled[src] > 0;
+}
+
+// called by the adc isr for every snapshot. only switches whose inputs
+// changed are evaluated, a changed switch marks its dependents dirty
+lswitch_state_t lswitch_process(const int16_t *rescaled) {
+    const lswitch_program_t *prog = lswitch_active;
+    const LSWITCH_DESC *desc;
+    lswitch_state_t state = lswitch_state;
+    lswitch_state_t changed = 0;
+    lswitch_state_t dirty, bit;
+    uint32_t i, on, in, reset;
+    int32_t value;
+
+    reset = (prog != lswitch_evaluated);
+    if (reset) {
+        // new program, evaluate everything. edges and latches only
+        // record their inputs during this pass
+        lswitch_evaluated = prog;
+        changed = state;
+        state = 0;
+        lswitch_prev_a = 0;
+        lswitch_prev_b = 0;
+        dirty = (1 << prog->count) - 1;
+        for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+            lswitch_input_last[i] = rescaled[i];
+        }
+    } else {
+        // pulses have to be turned off again
+        dirty = lswitch_pulse;
+        for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+            if (!prog->depends_channel[i]) {
+                continue;
+            }
+            value = rescaled[i] - lswitch_input_last[i];
+            if ((value >= LSWITCH_INPUT_DEADBAND) || (value <= -LSWITCH_INPUT_DEADBAND)) {
+                lswitch_input_last[i] = rescaled[i];
+                dirty |= prog->depends_channel[i];
+            }
+        }
+    }
+    lswitch_pulse = 0;
+
+    for (i = 0, bit = 1; dirty && (i < prog->count); i++, bit <<= 1) {
+        if (!(dirty & bit)) {
+            continue;
+        }
+        dirty &= ~bit;
+        desc = &prog->desc[i];
+        on = state & bit;
+
+        switch (desc->func & STORAGE_LSWITCH_FUNC_MASK) {
+            case (LSWITCH_FUNC_GT):
+                value = prog->threshold[i] - (on ? LSWITCH_HYSTERESIS : 0);
+                on = (rescaled[desc->a] > value);
+                break;
+
+            case (LSWITCH_FUNC_LT):
+                value = prog->threshold[i] + (on ? LSWITCH_HYSTERESIS : 0);
+                on = (rescaled[desc->a] < value);
+                break;
+
+            case (LSWITCH_FUNC_EDGE):
+                in = lswitch_source(rescaled, state, desc->a);
+                on = in && !(lswitch_prev_a & bit) && !reset;
+                lswitch_prev_a = in ? (lswitch_prev_a | bit) : (lswitch_prev_a & ~bit);
+                if (on) {
+                    lswitch_pulse |= bit;
+                }
+                break;
+
+            case (LSWITCH_FUNC_LATCH):
+                in = lswitch_source(rescaled, state, desc->a);
+                if (in && !(lswitch_prev_a & bit) && !reset) {
+                    on = 1;
+                }
+                lswitch_prev_a = in ? (lswitch_prev_a | bit) : (lswitch_prev_a & ~bit);
+                in = lswitch_source(rescaled, state, desc->b);
+                if (in && !(lswitch_prev_b & bit) && !reset) {
+                    on = 0;
+                }
+                lswitch_prev_b = in ? (lswitch_prev_b | bit) : (lswitch_prev_b & ~bit);
+                break;
+
+            default:
+                on = 0;
+                break;
+        }
+
+        if (!on != !(state & bit)) {
+            state ^= bit;
+            changed |= bit;
+            dirty |= prog->depends_switch[i];
+        }
+    }
+
+    lswitch_state = state;
+    lswitch_changes |= changed;
+    return state;
+}
+
+lswitch_state_t lswitch_get_state(void) {
+    return lswitch_state;
+}
+
+uint32_t lswitch_is_on(uint8_t index) {
+    if (index >= STORAGE_LSWITCH_COUNT) {
+        return 0;
+    }
+    return (lswitch_state >> index) & 1;
+}
+
+// returns all switches that changed since the last call. a pulse that
+// was on and off in between is reported as well
+lswitch_state_t lswitch_fetch_changes(void) {
+    lswitch_state_t changes;
+
+    // the adc isr is the only writer
+    nvic_disable_irq(ADC_DMA_IRQ);
+    changes = lswitch_changes;
+    lswitch_changes = 0;
+    nvic_enable_irq(ADC_DMA_IRQ);
+
+    return changes;
+}
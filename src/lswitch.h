@@ -0,0 +1,61 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+#ifndef LSWITCH_H_
+#define LSWITCH_H_
+
+#include <stdint.h>
+#include "adc.h"
+#include "storage.h"
+
+// logical switch functions (LSWITCH_DESC.func & STORAGE_LSWITCH_FUNC_MASK)
+// GT/LT: channel a above/below value %, with hysteresis
+// EDGE:  on for one evaluation when a turns on
+// LATCH: turned on by a, turned off by b
+#define LSWITCH_FUNC_NONE  0
+#define LSWITCH_FUNC_GT    1
+#define LSWITCH_FUNC_LT    2
+#define LSWITCH_FUNC_EDGE  3
+#define LSWITCH_FUNC_LATCH 4
+
+// a channel used as a boolean source is on when > 0
+// threshold hysteresis, 1% of the travel
+#define LSWITCH_HYSTERESIS 64
+// channel movement below this is not treated as an input change
+#define LSWITCH_INPUT_DEADBAND 16
+
+// all switches of the model, bit n = switch n
+typedef uint8_t lswitch_state_t;
+
+typedef struct {
+    uint8_t count;
+    LSWITCH_DESC desc[STORAGE_LSWITCH_COUNT];
+    int16_t threshold[STORAGE_LSWITCH_COUNT];
+    // switches that have to be re-evaluated when this channel/switch changes
+    lswitch_state_t depends_channel[CHANNEL_ID_SIZE];
+    lswitch_state_t depends_switch[STORAGE_LSWITCH_COUNT];
+} lswitch_program_t;
+
+void lswitch_init(void);
+void lswitch_compile(void);
+lswitch_state_t lswitch_process(const int16_t *rescaled);
+lswitch_state_t lswitch_get_state(void);
+lswitch_state_t lswitch_fetch_changes(void);
+uint32_t lswitch_is_on(uint8_t index);
+
+#endif  // LSWITCH_H_
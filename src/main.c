@@ -39,6 +39,10 @@
 #include "gui.h"
 #include "eeprom.h"
 #include "usb.h"
+#include "rftiming.h"
+#include "linkstats.h"
+#include "mixer.h"
+#include "lswitch.h"
 
 
 #include <stdlib.h>
@@ -175,7 +179,9 @@ int main(void) {
     debug_init();
 
 
+    lswitch_init();
     adc_init();
+    mixer_init();
     sound_init();
 
 
@@ -183,6 +189,8 @@ int main(void) {
     eeprom_init();
     storage_init();
 
+    rftiming_init();
+    linkstats_init();
     frsky_init();
 
     usb_init();
@@ -0,0 +1,201 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#include "mixer.h"
+#include "debug.h"
+#include "macros.h"
+#include <string.h>
+
+// the bottom half runs the active program, mixer_compile() builds the
+// other one and switches over once it is complete. the bottom half
+// preempts the main loop, thus it never sees a half compiled program
+static mixer_program_t mixer_program[2];
+static mixer_program_t * volatile mixer_active;
+
+// internal functions
+static void mixer_compile_expo(int16_t *lut, int8_t expo);
+static void mixer_compile_curve(int16_t *lut, const int8_t *curve);
+static int16_t mixer_coef(int16_t percent);
+static int32_t mixer_lut(const int16_t *lut, int32_t x);
+
+void mixer_init(void) {
+    debug("mixer: init\n"); debug_flush();
+
+    // empty program until the model is compiled by storage_load(),
+    // all channels stay centered
+    mixer_program[0].count = 0;
+    mixer_active = &mixer_program[0];
+}
+
+static int16_t mixer_coef(int16_t percent) {
+    return (percent * (1 << MIXER_COEF_SHIFT)) / 100;
+}
+
+// expo: y = x * ((1 - e) + e * x^2), normalised to +/- 3200
+static void mixer_compile_expo(int16_t *lut, int8_t expo) {
+    int32_t i, x, t;
+    int32_t e = max(0, min(100, expo));
+
+    for (i = 0; i < MIXER_LUT_POINTS; i++) {
+        x = -ADC_RESCALE_TARGET_RANGE + (i << MIXER_LUT_SHIFT);
+        t = (x * x) / ADC_RESCALE_TARGET_RANGE;
+        lut[i] = (x * ((100 - e) * ADC_RESCALE_TARGET_RANGE + e * t)) / (100 * ADC_RESCALE_TARGET_RANGE);
+    }
+}
+
+// model curve: linear interpolation between the curve points
+static void mixer_compile_curve(int16_t *lut, const int8_t *curve) {
+    int32_t i, x, seg, frac;
+    int32_t seg_width = (2 * ADC_RESCALE_TARGET_RANGE) / (STORAGE_CURVE_POINTS - 1);
+    int32_t y0, y1;
+
+    for (i = 0; i < MIXER_LUT_POINTS; i++) {
+        x = i << MIXER_LUT_SHIFT;
+        seg = min(x / seg_width, STORAGE_CURVE_POINTS - 2);
+        frac = x - seg * seg_width;
+        y0 = curve[seg] * ADC_RESCALE_TARGET_RANGE / 100;
+        y1 = curve[seg + 1] * ADC_RESCALE_TARGET_RANGE / 100;
+        lut[i] = y0 + ((y1 - y0) * frac) / seg_width;
+    }
+}
+
+// translate the current model into a program. all divisions are done
+// here, the per frame cost is bounded by MIXER_OP_MAX instructions
+void mixer_compile(void) {
+    MODEL_DESC *model = &storage.model[storage.current_model];
+    mixer_program_t *prog;
+    mixer_op_t *op;
+    uint32_t i;
+
+    // build the program that is not in use
+    if (mixer_active == &mixer_program[0]) {
+        prog = &mixer_program[1];
+    } else {
+        prog = &mixer_program[0];
+    }
+    prog->count = 0;
+
+    // expo and dual rates per stick, skipped if linear
+    for (i = 0; i < STORAGE_STICK_COUNT; i++) {
+        if ((model->expo[i] == 0) && (model->rate[i][0] == 100) &&
+            ((model->dr_switch >= STORAGE_LSWITCH_COUNT) || (model->rate[i][1] == 100))) {
+            continue;
+        }
+        op = &prog->op[prog->count++];
+        op->op  = MIXER_OP_INPUT;
+        op->src = i;
+        op->dst = i;
+        op->lut = MIXER_LUT_NONE;
+        if (model->expo[i] != 0) {
+            mixer_compile_expo(prog->lut[i], model->expo[i]);
+            op->lut = i;
+        }
+        op->sw = (model->dr_switch < STORAGE_LSWITCH_COUNT) ? model->dr_switch : STORAGE_LSWITCH_NONE;
+        op->coef[0] = mixer_coef(model->rate[i][0]);
+        op->coef[1] = mixer_coef(model->rate[i][1]);
+    }
+
+    // every output starts with its own input
+    op = &prog->op[prog->count++];
+    op->op = MIXER_OP_COPY;
+
+    mixer_compile_curve(prog->lut[MIXER_LUT_CURVE], model->curve);
+
+    for (i = 0; i < STORAGE_MIX_COUNT; i++) {
+        MIX_DESC *mix = &model->mix[i];
+        if ((mix->src >= CHANNEL_ID_SIZE) || (mix->dst >= CHANNEL_ID_SIZE) || (mix->weight == 0)) {
+            continue;
+        }
+        op = &prog->op[prog->count++];
+        op->op  = MIXER_OP_MIX;
+        op->src = mix->src;
+        op->dst = mix->dst;
+        op->lut = (mix->flags & STORAGE_MIX_FLAG_CURVE) ? MIXER_LUT_CURVE : MIXER_LUT_NONE;
+        op->sw  = STORAGE_LSWITCH_NONE;
+        op->coef[0] = mixer_coef(mix->weight);
+        op->coef[1] = op->coef[0];
+    }
+
+    // switch over
+    mixer_active = prog;
+
+    debug("mixer: compiled ");
+    debug_put_uint8(prog->count);
+    debug(" ops\n");
+    debug_flush();
+}
+
+static int32_t mixer_lut(const int16_t *lut, int32_t x) {
+    int32_t idx, frac;
+
+    x   += ADC_RESCALE_TARGET_RANGE;
+    idx  = x >> MIXER_LUT_SHIFT;
+    frac = x & ((1 << MIXER_LUT_SHIFT) - 1);
+
+    if (idx >= MIXER_LUT_POINTS - 1) {
+        return lut[MIXER_LUT_POINTS - 1];
+    }
+    return lut[idx] + (((lut[idx + 1] - lut[idx]) * frac) >> MIXER_LUT_SHIFT);
+}
+
+// input: rescaled channels (+/- 3200) and logical switches,
+// output: frsky packet data
+void mixer_process(const int16_t *input, uint32_t switches, uint16_t *packetdata) {
+    const mixer_program_t *prog = mixer_active;
+    int32_t in[CHANNEL_ID_SIZE];
+    int32_t out[CHANNEL_ID_SIZE];
+    int32_t value;
+    uint32_t i;
+
+    for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+        in[i]  = input[i];
+        out[i] = 0;
+    }
+
+    for (i = 0; i < prog->count; i++) {
+        const mixer_op_t *op = &prog->op[i];
+
+        if (op->op == MIXER_OP_COPY) {
+            memcpy(out, in, sizeof(out));
+            continue;
+        }
+
+        value = in[op->src];
+        if (op->lut != MIXER_LUT_NONE) {
+            value = mixer_lut(prog->lut[op->lut], value);
+        }
+        if ((op->sw != STORAGE_LSWITCH_NONE) && (switches & (1 << op->sw))) {
+            value = (value * op->coef[1]) >> MIXER_COEF_SHIFT;
+        } else {
+            value = (value * op->coef[0]) >> MIXER_COEF_SHIFT;
+        }
+
+        if (op->op == MIXER_OP_INPUT) {
+            in[op->dst] = value;
+        } else {
+            out[op->dst] += value;
+        }
+    }
+
+    for (i = 0; i < CHANNEL_ID_SIZE; i++) {
+        value = max(-ADC_RESCALE_TARGET_RANGE, min(ADC_RESCALE_TARGET_RANGE, out[i]));
+        // frsky packets send us * 1.5, remap +/-3200 to 1500..3000
+        packetdata[i] = ((15 * value) / 64) + 2250;
+    }
+}
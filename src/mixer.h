@@ -0,0 +1,67 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#ifndef MIXER_H_
+#define MIXER_H_
+
+#include <stdint.h>
+#include "adc.h"
+#include "storage.h"
+
+// lookup tables cover -3200 ... 3200 in 25 segments of 256
+#define MIXER_LUT_SHIFT  8
+#define MIXER_LUT_POINTS (((2 * ADC_RESCALE_TARGET_RANGE) >> MIXER_LUT_SHIFT) + 1)
+// one lut per stick (expo) and the model curve
+#define MIXER_LUT_CURVE  STORAGE_STICK_COUNT
+#define MIXER_LUT_COUNT  (STORAGE_STICK_COUNT + 1)
+#define MIXER_LUT_NONE   0xFF
+
+// weights and rates are applied as (value * coef) >> MIXER_COEF_SHIFT
+#define MIXER_COEF_SHIFT 12
+
+// instructions
+// INPUT: in[src] = lut(in[src]) * coef  (expo and dual rate)
+// COPY:  out[] = in[]
+// MIX:   out[dst] += lut(in[src]) * coef
+#define MIXER_OP_INPUT 0
+#define MIXER_OP_COPY  1
+#define MIXER_OP_MIX   2
+#define MIXER_OP_MAX   (STORAGE_STICK_COUNT + 1 + STORAGE_MIX_COUNT)
+
+typedef struct {
+    uint8_t op;
+    uint8_t src;
+    uint8_t dst;
+    uint8_t lut;
+    // coef[1] is used while logical switch sw is on
+    uint8_t sw;
+    int16_t coef[2];
+} mixer_op_t;
+
+typedef struct {
+    uint8_t count;
+    mixer_op_t op[MIXER_OP_MAX];
+    int16_t lut[MIXER_LUT_COUNT][MIXER_LUT_POINTS];
+} mixer_program_t;
+
+void mixer_init(void);
+void mixer_compile(void);
+void mixer_process(const int16_t *input, uint32_t switches, uint16_t *packetdata);
+
+#endif  // MIXER_H_
@@ -0,0 +1,233 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#include "rftiming.h"
+#include "debug.h"
+#include "macros.h"
+#include "clocksource.h"
+#include "seqlock.h"
+#include <libopencm3/stm32/rcc.h>
+
+// per slot time spent in the rf isr
+static rftiming_stat_t rftiming_slot_stat[RFTIMING_SLOT_COUNT];
+// strobe latency relative to the slot start (the ideal grid)
+static rftiming_stat_t rftiming_strobe_stat[RFTIMING_STROBE_COUNT];
+static uint16_t rftiming_histogram[RFTIMING_HISTOGRAM_BINS];
+// age of the stick data when the packet went out
+static rftiming_stat_t rftiming_stick_age_stat;
+// guards all of the above against the gui
+static seqlock_t rftiming_seqlock;
+// set by the gui, the rf isr clears the stats
+static volatile uint8_t rftiming_reset_request;
+
+// timestamps of the current slot
+static uint32_t rftiming_slot_start;
+static uint32_t rftiming_isr_enter;
+static uint8_t rftiming_slot;
+
+// internal functions
+static void rftiming_stat_add(rftiming_stat_t *stat, uint32_t value);
+static void rftiming_dump_stat(char *name, rftiming_stat_t *stat);
+static void rftiming_stat_reset(rftiming_stat_t *stat);
+static void rftiming_clear(void);
+static void rftiming_get_stat(rftiming_stat_t *src, rftiming_stat_t *stat);
+
+void rftiming_init(void) {
+    debug("rftiming: init\n"); debug_flush();
+
+    rcc_periph_clock_enable(RCC_TIM2);
+    timer_reset(RFTIMING_TIMER);
+
+    // free running 32 bit timer, one tick is 1us
+    uint16_t prescaler = (uint16_t) (rcc_timer_frequency  / 1000000) - 1;
+    timer_set_prescaler(RFTIMING_TIMER, prescaler);
+    timer_set_mode(RFTIMING_TIMER, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
+    timer_set_period(RFTIMING_TIMER, 0xFFFFFFFF);
+    timer_enable_counter(RFTIMING_TIMER);
+
+    seqlock_init(&rftiming_seqlock);
+    rftiming_reset_request = 0;
+    rftiming_clear();
+}
+
+// the stats are only written from the rf isr priority, the
+// reset is done there with the next slot
+void rftiming_reset(void) {
+    rftiming_reset_request = 1;
+}
+
+static void rftiming_clear(void) {
+    uint32_t i;
+
+    seqlock_write_begin(&rftiming_seqlock);
+    for (i = 0; i < RFTIMING_SLOT_COUNT; i++) {
+        rftiming_stat_reset(&rftiming_slot_stat[i]);
+    }
+    for (i = 0; i < RFTIMING_STROBE_COUNT; i++) {
+        rftiming_stat_reset(&rftiming_strobe_stat[i]);
+    }
+    for (i = 0; i < RFTIMING_HISTOGRAM_BINS; i++) {
+        rftiming_histogram[i] = 0;
+    }
+    rftiming_stat_reset(&rftiming_stick_age_stat);
+    seqlock_write_end(&rftiming_seqlock);
+}
+
+static void rftiming_stat_reset(rftiming_stat_t *stat) {
+    stat->min   = 0xFFFF;
+    stat->max   = 0;
+    stat->sum   = 0;
+    stat->count = 0;
+}
+
+static void rftiming_stat_add(rftiming_stat_t *stat, uint32_t value) {
+    if (value > 0xFFFF) {
+        value = 0xFFFF;
+    }
+    seqlock_write_begin(&rftiming_seqlock);
+    stat->min  = min(stat->min, value);
+    stat->max  = max(stat->max, value);
+    stat->sum += value;
+    stat->count++;
+    seqlock_write_end(&rftiming_seqlock);
+}
+
+// called on rf isr entry. slot_elapsed is the slot timer counter,
+// i.e. the time since the slot started on the hardware grid
+void rftiming_slot_enter(uint8_t slot, uint16_t slot_elapsed) {
+    rftiming_isr_enter  = rftiming_now();
+    rftiming_slot_start = rftiming_isr_enter - slot_elapsed;
+    rftiming_slot       = slot;
+}
+
+void rftiming_slot_exit(void) {
+    if (rftiming_reset_request) {
+        rftiming_reset_request = 0;
+        rftiming_clear();
+    }
+
+    if (rftiming_slot >= RFTIMING_SLOT_COUNT) {
+        return;
+    }
+    rftiming_stat_add(&rftiming_slot_stat[rftiming_slot], rftiming_now() - rftiming_isr_enter);
+}
+
+// called once the strobe was actually clocked out to the cc2500
+void rftiming_strobe(uint8_t strobe) {
+    uint32_t latency = rftiming_now() - rftiming_slot_start;
+
+    rftiming_stat_add(&rftiming_strobe_stat[strobe], latency);
+
+    if (strobe == RFTIMING_STROBE_STX) {
+        uint32_t bin = latency >> RFTIMING_HISTOGRAM_SHIFT;
+        if (bin >= RFTIMING_HISTOGRAM_BINS) {
+            bin = RFTIMING_HISTOGRAM_BINS - 1;
+        }
+        // saturate instead of wrapping around
+        seqlock_write_begin(&rftiming_seqlock);
+        if (rftiming_histogram[bin] != 0xFFFF) {
+            rftiming_histogram[bin]++;
+        }
+        seqlock_write_end(&rftiming_seqlock);
+    }
+}
+
+// time between the adc snapshot and the stx strobe of the packet using it
+void rftiming_stick_age(uint32_t age) {
+    rftiming_stat_add(&rftiming_stick_age_stat, age);
+}
+
+static void rftiming_get_stat(rftiming_stat_t *src, rftiming_stat_t *stat) {
+    uint32_t sequence;
+
+    do {
+        sequence = seqlock_read_begin(&rftiming_seqlock);
+        *stat = *src;
+    } while (seqlock_read_retry(&rftiming_seqlock, sequence));
+}
+
+void rftiming_get_slot_stat(uint8_t slot, rftiming_stat_t *stat) {
+    rftiming_get_stat(&rftiming_slot_stat[slot], stat);
+}
+
+void rftiming_get_strobe_stat(uint8_t strobe, rftiming_stat_t *stat) {
+    rftiming_get_stat(&rftiming_strobe_stat[strobe], stat);
+}
+
+void rftiming_get_stick_age_stat(rftiming_stat_t *stat) {
+    rftiming_get_stat(&rftiming_stick_age_stat, stat);
+}
+
+void rftiming_get_histogram(uint16_t *histogram) {
+    uint32_t sequence, i;
+
+    do {
+        sequence = seqlock_read_begin(&rftiming_seqlock);
+        for (i = 0; i < RFTIMING_HISTOGRAM_BINS; i++) {
+            histogram[i] = rftiming_histogram[i];
+        }
+    } while (seqlock_read_retry(&rftiming_seqlock, sequence));
+}
+
+uint16_t rftiming_stat_mean(rftiming_stat_t *stat) {
+    if (stat->count == 0) {
+        return 0;
+    }
+    return stat->sum / stat->count;
+}
+
+static void rftiming_dump_stat(char *name, rftiming_stat_t *stat) {
+    debug(name);
+    debug(" min ");
+    debug_put_uint16(stat->count ? stat->min : 0);
+    debug(" avg ");
+    debug_put_uint16(rftiming_stat_mean(stat));
+    debug(" max ");
+    debug_put_uint16(stat->max);
+    debug_put_newline();
+    debug_flush();
+}
+
+void rftiming_dump(void) {
+    uint32_t i;
+
+    debug("rftiming: isr us / slot\n");
+    for (i = 0; i < RFTIMING_SLOT_COUNT; i++) {
+        if (rftiming_slot_stat[i].count == 0) {
+            continue;
+        }
+        debug_put_uint8(i);
+        rftiming_dump_stat(":", &rftiming_slot_stat[i]);
+    }
+
+    debug("rftiming: strobe latency us\n");
+    rftiming_dump_stat("stx", &rftiming_strobe_stat[RFTIMING_STROBE_STX]);
+    rftiming_dump_stat("srx", &rftiming_strobe_stat[RFTIMING_STROBE_SRX]);
+
+    debug("rftiming: stick age us\n");
+    rftiming_dump_stat("age", &rftiming_stick_age_stat);
+
+    debug("rftiming: stx histogram\n");
+    for (i = 0; i < RFTIMING_HISTOGRAM_BINS; i++) {
+        debug_put_uint16(rftiming_histogram[i]);
+        debug(" ");
+    }
+    debug_put_newline();
+    debug_flush();
+}
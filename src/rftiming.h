@@ -0,0 +1,64 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+
+#ifndef RFTIMING_H_
+#define RFTIMING_H_
+
+#include <stdint.h>
+#include <libopencm3/stm32/timer.h>
+
+// number of schedule slots tracked
+#define RFTIMING_SLOT_COUNT 12
+
+// strobe latency relative to the slot start
+#define RFTIMING_STROBE_STX   0
+#define RFTIMING_STROBE_SRX   1
+#define RFTIMING_STROBE_COUNT 2
+
+// stx jitter histogram, 16us per bin, last bin collects everything above
+#define RFTIMING_HISTOGRAM_BINS  16
+#define RFTIMING_HISTOGRAM_SHIFT 4
+
+// free running 1MHz timestamp
+#define RFTIMING_TIMER TIM2
+#define rftiming_now() (TIM_CNT(RFTIMING_TIMER))
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint32_t count;
+} rftiming_stat_t;
+
+void rftiming_init(void);
+void rftiming_reset(void);
+void rftiming_slot_enter(uint8_t slot, uint16_t slot_elapsed);
+void rftiming_slot_exit(void);
+void rftiming_strobe(uint8_t strobe);
+void rftiming_stick_age(uint32_t age);
+void rftiming_dump(void);
+
+// consistent copies, the stats are updated from several isrs
+void rftiming_get_slot_stat(uint8_t slot, rftiming_stat_t *stat);
+void rftiming_get_strobe_stat(uint8_t strobe, rftiming_stat_t *stat);
+void rftiming_get_stick_age_stat(rftiming_stat_t *stat);
+void rftiming_get_histogram(uint16_t *histogram);
+uint16_t rftiming_stat_mean(rftiming_stat_t *stat);
+
+#endif  // RFTIMING_H_
@@ -26,14 +26,36 @@
 #include "font.h"
 #include "delay.h"
 #include "led.h"
-
-static uint8_t screen_buffer[SCREEN_BUFFER_SIZE];
-static const uint8_t *screen_font_ptr;
+#include <string.h>
+
+#if SCREEN_DOUBLE_BUFFER
+// the front buffer is sent by the lcd dma engine while we draw into the back buffer
+static uint8_t screen_framebuffer[2][SCREEN_BUFFER_SIZE];
+static uint8_t *screen_front;
+#else
+static uint8_t screen_framebuffer[1][SCREEN_BUFFER_SIZE];
+// set while the lcd dma engine might still read screen_buffer
+static uint8_t screen_flush_pending;
+#endif  // SCREEN_DOUBLE_BUFFER
+// the buffer all drawing functions work on
+static uint8_t *screen_buffer = screen_framebuffer[0];
+static const font_t *screen_font;
 static uint32_t screen_font_x;
 static uint32_t screen_font_y;
 static uint8_t  screen_font_color;
+// columns changed since the last screen_update, per page
+static lcd_window_t screen_dirty[LCD_PAGES];
+
+// internal functions
+static void screen_dirty_mark(uint32_t page, uint32_t x0, uint32_t x1);
+static void screen_dirty_clear(void);
+static uint8_t screen_put_missing_glyph(void);
 
 void screen_init(void) {
+#if SCREEN_DOUBLE_BUFFER
+    screen_front = screen_framebuffer[1];
+#endif  // SCREEN_DOUBLE_BUFFER
+    screen_dirty_clear();
     screen_clear();
     led_backlight_on();
 }
@@ -44,7 +66,61 @@ void screen_clear(void) {
 }
 
 void screen_update(void) {
-    lcd_send_data(screen_buffer);
+#if SCREEN_DOUBLE_BUFFER
+    uint8_t *back = screen_front;
+    uint32_t i, offset;
+
+    // swap buffers and send the new front buffer in the background.
+    // this waits for the previous frame, so the old front buffer is free
+    screen_front = screen_buffer;
+    lcd_send_windows(screen_front, screen_dirty);
+
+    // the new back buffer still holds the previous frame, it only
+    // differs in the windows drawn since then. copy those over
+    for (i = 0; i < LCD_PAGES; i++) {
+        if (screen_dirty[i].x0 <= screen_dirty[i].x1) {
+            offset = i * LCD_WIDTH + screen_dirty[i].x0;
+            memcpy(&back[offset], &screen_front[offset], screen_dirty[i].x1 - screen_dirty[i].x0 + 1);
+        }
+    }
+    screen_buffer = back;
+#else
+    // only send the changed windows, this runs in the background
+    lcd_send_windows(screen_buffer, screen_dirty);
+    screen_flush_pending = 1;
+#endif  // SCREEN_DOUBLE_BUFFER
+    screen_dirty_clear();
+}
+
+static void screen_dirty_clear(void) {
+    uint32_t i;
+    for (i = 0; i < LCD_PAGES; i++) {
+        screen_dirty[i].x0 = LCD_WIDTH;
+        screen_dirty[i].x1 = 0;
+    }
+}
+
+// every primitive marks its area before it modifies the buffer
+static void screen_dirty_mark(uint32_t page, uint32_t x0, uint32_t x1) {
+#if !SCREEN_DOUBLE_BUFFER
+    if (screen_flush_pending) {
+        // do not modify the buffer while it is sent
+        lcd_wait();
+        screen_flush_pending = 0;
+    }
+#endif  // SCREEN_DOUBLE_BUFFER
+    if ((page >= LCD_PAGES) || (x0 >= LCD_WIDTH)) {
+        return;
+    }
+    if (x1 >= LCD_WIDTH) {
+        x1 = LCD_WIDTH - 1;
+    }
+    if (x0 < screen_dirty[page].x0) {
+        screen_dirty[page].x0 = x0;
+    }
+    if (x1 > screen_dirty[page].x1) {
+        screen_dirty[page].x1 = x1;
+    }
 }
 
 void screen_test(void) {
@@ -114,6 +190,10 @@ void screen_set_pixels(uint8_t x, uint8_t y, uint8_t x2, uint8_t y2, uint8_t col
     uint8_t width = x2-x+1;
     uint16_t dpos = 0;
 
+    for (i = y/8; i <= y2/8; i++) {
+        screen_dirty_mark(i, x, x2);
+    }
+
     pageOffset = y%8;
     y -= pageOffset;
     mask = 0xFF;
@@ -266,57 +346,29 @@ void screen_fill_round_rect(uint8_t x, uint8_t y, uint8_t width,
 }
 
 uint8_t screen_put_char(char c) {
-    uint8_t thielefont = 0;
     uint8_t width      = 0;
-    uint8_t height     = screen_font_ptr[FONT_HEIGHT];
-    uint8_t bytes      = (height+7)/ 8;  // calculates height in rounded up bytes
-    uint8_t firstChar  = screen_font_ptr[FONT_FIRST_CHAR];
-    uint8_t charCount  = screen_font_ptr[FONT_CHAR_COUNT];
-    uint32_t index     = 0;
-    uint32_t i;
-
-    if (c < firstChar || c >= (firstChar+charCount)) {
-        return 0;  // invalid char
+    uint8_t height     = screen_font->height;
+    uint8_t firstChar  = screen_font->first_char;
+    uint8_t charCount  = screen_font->char_count;
+    uint8_t glyph;
+    const uint8_t *glyph_data;
+
+    if ((uint8_t)c < firstChar || (uint8_t)c >= (firstChar+charCount)) {
+        glyph = FONT_GLYPH_NONE;
+    } else {
+        // direct lookup in the compiled font tables
+        glyph = screen_font->glyph[(uint8_t)c - firstChar];
     }
-    c-= firstChar;
 
-
-    if (font_is_fixed_width(screen_font_ptr)) {
-        thielefont = 0;
-        width = screen_font_ptr[FONT_FIXED_WIDTH];
-        index = c*bytes*width+FONT_WIDTH_TABLE;
-    } else {
-        // variable width font, read width data, to get the index
-        thielefont = 1;
-        /*
-        * Because there is no table for the offset of where the data
-        * for each character glyph starts, run the table and add up all the
-        * widths of all the characters prior to the character we
-        * need to locate.
-        */
-        for (i = 0; i < c; i++) {
-            index += screen_font_ptr[FONT_WIDTH_TABLE+i];
+    if (glyph == FONT_GLYPH_NONE) {
+        if (screen_font->flags & FONT_FLAG_SUBSET) {
+            // not compiled into the font subset, see Makefile
+            return screen_put_missing_glyph();
         }
-
-        /*
-        * Calculate the offset of where the font data
-        * for our character starts.
-        * The index value from above has to be adjusted because
-        * there is potentialy more than 1 byte per column in the glyph,
-        * when the characgter is taller than 8 bits.
-        * To account for this, index has to be multiplied
-        * by the height in bytes because there is one byte of font
-        * data for each vertical 8 pixels.
-        * The index is then adjusted to skip over the font width data
-        * and the font header information.
-        */
-        index = index*bytes+charCount+FONT_WIDTH_TABLE;
-
-        /*
-        * Finally, fetch the width of our character
-        */
-        width = screen_font_ptr[FONT_WIDTH_TABLE+c];
+        return 0;  // invalid char
     }
+    width      = screen_font->glyph_width[glyph];
+    glyph_data = &screen_font->data[screen_font->glyph_offset[glyph]];
 
 
     if (!width) {
@@ -353,7 +405,7 @@ uint8_t screen_put_char(char c) {
     uint8_t fdata;
     uint32_t j;
 
-    if (!font_is_nopad_fixed_font(screen_font_ptr)) {
+    if (!(screen_font->flags & FONT_FLAG_NOPAD)) {
         pixels++;  // extra pixel on bottom for spacing on all fonts but NoPadFixed fonts
     }
 
@@ -390,17 +442,8 @@ uint8_t screen_put_char(char c) {
                 */
                 fdata = 0;
             } else {
-                fdata = screen_font_ptr[index + page + j];
-                /*
-                * Have to shift font data because Thiele shifted residual
-                * font bits the wrong direction for LCD memory.
-                *
-                * The real solution to this is to fix the variable width font format to
-                * not shift the residual bits the wrong direction!!!!
-                */
-                if (thielefont && (height - (p&~7)) < 8) {
-                    fdata >>= 8 - (height & 7);
-                }
+                // compiled fonts are lcd page native, no thiele fixup needed
+                fdata = glyph_data[page + j];
             }
 
             if (!screen_font_color) {
@@ -454,20 +497,11 @@ uint8_t screen_put_char(char c) {
                 * Check for crossing font data bytes
                 */
                 if ((tfp & 7)== 7) {
-                    fdata = screen_font_ptr[index + page + j + width];
-
-                    /*
-                    * Have to shift font data because Thiele shifted residual
-                    * font bits the wrong direction for LCD memory.
-                    *
-                    * Note: the 8+1 is there vs 8 because we are fetching the font
-                    * data byte for the next pixel, but tfp has not yet incremented yet
-                    * so it is one less then it should be. We add 1 to the 8
-                    * to account for this.
-                    */
-
-                    if ((thielefont) && ((height - tfp) < (8+1))) {
-                        fdata >>= (8 - (height & 7));
+                    if ((tfp + 1) < height) {
+                        fdata = glyph_data[page + j + width];
+                    } else {
+                        // padding below the glyph
+                        fdata = 0;
                     }
 
                     if (!screen_font_color) {
@@ -504,7 +538,7 @@ uint8_t screen_put_char(char c) {
         */
 
 
-        if (!font_is_nopad_fixed_font(screen_font_ptr)) {
+        if (!(screen_font->flags & FONT_FLAG_NOPAD)) {
             // extra pixel on right for spacing on all fonts but NoPadFixed fonts
             if ((dy & 7) || (pixels - p < 8)) {
                 uint8_t mask = 0;
@@ -552,13 +586,26 @@ uint8_t screen_put_char(char c) {
     */
     screen_font_x += width;  // pixels rendered in character glyph
 
-    if (!font_is_nopad_fixed_font(screen_font_ptr)) {
+    if (!(screen_font->flags & FONT_FLAG_NOPAD)) {
         screen_font_x++;  // skip over pad pixel we rendered
     }
 
     return 1;  // valid char
 }
 
+// a box instead of a char missing in a font subset, a label using
+// chars that were not compiled in should be noticed, not vanish
+static uint8_t screen_put_missing_glyph(void) {
+    screen_draw_rect(screen_font_x, screen_font_y, screen_font->width, screen_font->height, screen_font_color);
+
+    screen_font_x += screen_font->width;
+    if (!(screen_font->flags & FONT_FLAG_NOPAD)) {
+        screen_font_x++;
+    }
+
+    return 0;  // invalid char
+}
+
 void screen_puts_xy(uint8_t x, uint8_t y, uint8_t color, char *str) {
     screen_font_x = x;
     screen_font_y = y;
@@ -570,21 +617,41 @@ void screen_puts_xy(uint8_t x, uint8_t y, uint8_t color, char *str) {
     }
 }
 
+// rendered width in pixels, one table lookup per char
 uint32_t screen_strlen(char *str) {
     uint32_t len = 0;
-    while (*str++) {
-        len++;
-        if (len > 50) {
-            // just in case... we do not handle longer strings
-            break;
+    uint32_t width = 0;
+    uint32_t pad = (screen_font->flags & FONT_FLAG_NOPAD) ? 0 : 1;
+    uint8_t c, glyph;
+
+    if (screen_font->flags & FONT_FLAG_FIXED) {
+        while (*str++) {
+            len++;
+            if (len > 50) {
+                // just in case... we do not handle longer strings
+                break;
+            }
+        }
+        return (screen_font->width + pad) * len;
+    }
+
+    while ((c = (uint8_t)*str++) && (len++ < 50)) {
+        glyph = FONT_GLYPH_NONE;
+        if ((c >= screen_font->first_char) && (c < screen_font->first_char + screen_font->char_count)) {
+            glyph = screen_font->glyph[c - screen_font->first_char];
+        }
+        if (glyph != FONT_GLYPH_NONE) {
+            width += screen_font->glyph_width[glyph] + pad;
+        } else if (screen_font->flags & FONT_FLAG_SUBSET) {
+            // rendered as a box by screen_put_missing_glyph()
+            width += screen_font->width + pad;
         }
     }
-    return (screen_font_ptr[FONT_FIXED_WIDTH] + 1) * len;
+    return width;
 }
 
 void screen_puts_xy_centered(uint8_t x, uint8_t y, uint8_t color, char *str) {
-    // uint32_t font_w = screen_font_ptr[FONT_FIXED_WIDTH];
-    uint32_t font_h = screen_font_ptr[FONT_HEIGHT];
+    uint32_t font_h = screen_font->height;
 
     uint32_t len = (uint32_t) screen_strlen(str);
     uint32_t sx = x - (len) / 2;
@@ -640,21 +707,21 @@ void screen_put_time(uint8_t x, uint8_t y, uint8_t c, int16_t time) {
     if (time < 0) {
         time = -time;
         // render '-' char
-        screen_fill_rect(x, y + screen_font_ptr[FONT_HEIGHT]/2 - 1,
-                         screen_font_ptr[FONT_FIXED_WIDTH]/2, 3, color);
+        screen_fill_rect(x, y + screen_font->height/2 - 1,
+                         screen_font->width/2, 3, color);
     }
 
     int16_t minutes = time / 60;
     int16_t seconds = time % 60;
 
     // put minutes
-    x = x + (screen_font_ptr[FONT_FIXED_WIDTH]/2 + 2);
+    x = x + (screen_font->width/2 + 2);
     screen_put_uint8_2dec(x, y, color, minutes);
-    x = x + (screen_font_ptr[FONT_FIXED_WIDTH] + 1) * 2;
+    x = x + (screen_font->width + 1) * 2;
 
     // render colon
-    screen_fill_rect(x, y + screen_font_ptr[FONT_HEIGHT]*3/8, 2, 2, color);
-    screen_fill_rect(x, y + screen_font_ptr[FONT_HEIGHT]*5/8, 2, 2, color);
+    screen_fill_rect(x, y + screen_font->height*3/8, 2, 2, color);
+    screen_fill_rect(x, y + screen_font->height*5/8, 2, 2, color);
 
     // put seconds
     x = x + 3;
@@ -668,10 +735,10 @@ void screen_put_fixed2_1digit(uint8_t x, uint8_t y, uint8_t color, uint32_t v) {
 
     // put v
     screen_put_uint8_2dec(x, y, color, full);
-    x = x + (screen_font_ptr[FONT_FIXED_WIDTH] + 1) * 2;
+    x = x + (screen_font->width + 1) * 2;
 
     // render point
-    screen_fill_rect(x, y + screen_font_ptr[FONT_HEIGHT]*7/8, 2, 2, color);
+    screen_fill_rect(x, y + screen_font->height*7/8, 2, 2, color);
 
     // put frac
     x = x + 3;
@@ -873,16 +940,21 @@ void screen_put_fixed2(uint8_t x, uint8_t y, uint8_t color, uint16_t c) {
     screen_put_char('0' + (uint8_t)c);
 }
 
-void screen_set_font(const uint8_t *font, uint32_t *h, uint32_t *w) {
-    screen_font_ptr = font;
+void screen_set_font(const font_t *font, uint32_t *h, uint32_t *w) {
+    screen_font = font;
 
     // return font size if requested:
-    if (h != 0) *h = screen_font_ptr[FONT_HEIGHT]+1;
-    if (w != 0) *w = screen_font_ptr[FONT_FIXED_WIDTH]+1;
+    if (h != 0) *h = screen_font->height+1;
+    if (w != 0) *w = screen_font->width+1;
 }
 
 void screen_fill(uint8_t color) {
     uint32_t i;
+
+    for (i = 0; i < LCD_PAGES; i++) {
+        screen_dirty_mark(i, 0, LCD_WIDTH - 1);
+    }
+
     // this is optimized for runtime, do not move the if into the for loop!
     if (color) {
         for (i = 0; i < SCREEN_BUFFER_SIZE; i++) {
@@ -24,8 +24,14 @@
 
 #include "config.h"
 #include "lcd.h"
+#include "font.h"
 
 #define SCREEN_BUFFER_SIZE ((LCD_WIDTH * LCD_HEIGHT) / 8)
+// render into a back buffer while the front buffer is sent. costs
+// another SCREEN_BUFFER_SIZE bytes of ram, set to 0 on low ram builds
+#ifndef SCREEN_DOUBLE_BUFFER
+#define SCREEN_DOUBLE_BUFFER 1
+#endif  // SCREEN_DOUBLE_BUFFER
 // extern static uint8_t screen_buffer[SCREEN_BUFFER_SIZE];
 
 void screen_init(void);
@@ -51,7 +57,7 @@ void screen_draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t co
 
 uint8_t screen_put_char(char c);
 uint32_t screen_strlen(char *str);
-void screen_set_font(const uint8_t *font, uint32_t *h, uint32_t *w);
+void screen_set_font(const font_t *font, uint32_t *h, uint32_t *w);
 void screen_puts_xy(uint8_t x, uint8_t y, uint8_t color, char *str);
 void screen_puts_xy_centered(uint8_t y, uint8_t x, uint8_t color, char *str);
 void screen_puts_centered(uint8_t y, uint8_t color, char *str);
@@ -72,6 +78,7 @@ void screen_fill(uint8_t color);
     if (_addr >= SCREEN_BUFFER_SIZE) { \
         /*Serial.write("ERROR: "); Serial.print(_addr); Serial.write("\r\n");*/ \
     } else { \
+        screen_dirty_mark((_addr) / 128, (_addr) % 128, (_addr) % 128); \
         screen_buffer[_addr] = (uint8_t)_val; \
     } \
 }
@@ -81,6 +88,7 @@ void screen_fill(uint8_t color);
 
 #define screen_set_dot(x, y, color) { \
   if (((x) >= LCD_WIDTH) || ((y) >= LCD_HEIGHT)) { return; } \
+  screen_dirty_mark((y)/8, (x), (x)); \
   if (color) { \
     screen_buffer[((y)/8)*128 + (x)] |= (1 << ((y) % 8)); \
   } else { \
@@ -0,0 +1,70 @@
+/*
+    Copyright 2016 fishpepper <AT> gmail.com
+
+    This program is free software: you can redistribute it and/ or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http:// www.gnu.org/licenses/>.
+
+    author: fishpepper <AT> gmail.com
+*/
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <stdint.h>
+
+// sequence counter for data written in an isr and read by lower
+// priority code. the writer increments the counter before and after
+// the update, a reader copies the data and retries if the counter was
+// odd or has changed meanwhile. neither side disables interrupts.
+//
+// writer:  seqlock_write_begin(&seq); ...update... seqlock_write_end(&seq);
+// reader:  do {
+//              start = seqlock_read_begin(&seq);
+//              ...copy...
+//          } while (seqlock_read_retry(&seq, start));
+//
+// readers must have a lower priority than all writers, otherwise they
+// would spin forever on an interrupted update. there can only be one
+// writer priority: the increment is a plain load/add/store on the m0,
+// a writer preempting another one would lose counts. code running at
+// other priorities has to hand its change to the writer (e.g. a flag).
+typedef volatile uint32_t seqlock_t;
+
+// orders the data access against the counter access
+#define SEQLOCK_BARRIER() __asm__ volatile ("dmb" ::: "memory")
+
+static inline void seqlock_init(seqlock_t *seq) {
+    *seq = 0;
+}
+
+static inline void seqlock_write_begin(seqlock_t *seq) {
+    (*seq)++;
+    SEQLOCK_BARRIER();
+}
+
+static inline void seqlock_write_end(seqlock_t *seq) {
+    SEQLOCK_BARRIER();
+    (*seq)++;
+}
+
+static inline uint32_t seqlock_read_begin(const seqlock_t *seq) {
+    uint32_t start = *seq;
+    SEQLOCK_BARRIER();
+    return start;
+}
+
+static inline uint32_t seqlock_read_retry(const seqlock_t *seq, uint32_t start) {
+    SEQLOCK_BARRIER();
+    return (start & 1) || (start != *seq);
+}
+
+#endif  // SEQLOCK_H_
@@ -105,8 +105,9 @@ static void spi_init_dma(void) {
     rcc_periph_clock_enable(RCC_DMA);
 
     // DMA NVIC
+    // the transfer complete irq is only used by the async transfers
     nvic_set_priority(NVIC_DMA1_CHANNEL2_3_IRQ, NVIC_PRIO_FRSKY);
-    // nvic_enable_irq(NVIC_DMA1_CHANNEL2_3_IRQ); // NO IRQ beeing used here
+    nvic_enable_irq(NVIC_DMA1_CHANNEL2_3_IRQ);
 
     // start with clean init for RX channel
     dma_channel_reset(DMA1, CC2500_SPI_RX_DMA_CHANNEL);
@@ -158,6 +159,9 @@ static void spi_init_dma(void) {
 void spi_dma_xfer(uint8_t *buffer, uint8_t len) {
     // debug("xfer "); debug_put_uint8(len); debug(")\n");
 
+    // blocking transfer, no irq
+    dma_disable_transfer_complete_interrupt(DMA1, CC2500_SPI_RX_DMA_CHANNEL);
+
     // TX: transfer buffer to slave
     dma_set_memory_address(DMA1, CC2500_SPI_TX_DMA_CHANNEL, (uint32_t)buffer);
     dma_set_number_of_data(DMA1, CC2500_SPI_TX_DMA_CHANNEL, len);
@@ -184,6 +188,45 @@ void spi_dma_xfer(uint8_t *buffer, uint8_t len) {
     dma_disable_channel(DMA1, CC2500_SPI_TX_DMA_CHANNEL);
 }
 
+// same as spi_dma_xfer() but returns immediately. completion is
+// signalled by the rx dma transfer complete irq which hands over to
+// cc2500_queue_xfer_done(). the buffer has to stay valid until then.
+void spi_dma_xfer_async(uint8_t *buffer, uint8_t len) {
+    // TX: transfer buffer to slave
+    dma_set_memory_address(DMA1, CC2500_SPI_TX_DMA_CHANNEL, (uint32_t)buffer);
+    dma_set_number_of_data(DMA1, CC2500_SPI_TX_DMA_CHANNEL, len);
+
+    // RX: read back data from slave
+    dma_set_memory_address(DMA1, CC2500_SPI_RX_DMA_CHANNEL, (uint32_t)buffer);
+    dma_set_number_of_data(DMA1, CC2500_SPI_RX_DMA_CHANNEL, len);
+
+    // the last rx byte marks the end of the transfer, make sure
+    // there is no stale flag left from a blocking transfer
+    dma_clear_interrupt_flags(DMA1, CC2500_SPI_RX_DMA_CHANNEL, DMA_TCIF);
+    dma_enable_transfer_complete_interrupt(DMA1, CC2500_SPI_RX_DMA_CHANNEL);
+
+    // enable both dma channels
+    dma_enable_channel(DMA1, CC2500_SPI_RX_DMA_CHANNEL);
+    dma_enable_channel(DMA1, CC2500_SPI_TX_DMA_CHANNEL);
+
+    // trigger the SPI TX + RX dma
+    spi_enable_tx_dma(CC2500_SPI);
+    spi_enable_rx_dma(CC2500_SPI);
+}
+
+void DMA1_CHANNEL2_3_IRQHandler(void) {
+    if (dma_get_interrupt_flag(DMA1, CC2500_SPI_RX_DMA_CHANNEL, DMA_TCIF)) {
+        dma_clear_interrupt_flags(DMA1, CC2500_SPI_RX_DMA_CHANNEL, DMA_TCIF);
+
+        // disable DMA
+        dma_disable_channel(DMA1, CC2500_SPI_RX_DMA_CHANNEL);
+        dma_disable_channel(DMA1, CC2500_SPI_TX_DMA_CHANNEL);
+
+        // all bytes are shifted out and in, hand over to the cc2500 queue
+        cc2500_queue_xfer_done();
+    }
+}
+
 
 static void spi_init_gpio(void) {
     // init sck, mosi and miso
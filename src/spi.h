@@ -27,6 +27,7 @@
 
 void spi_init(void);
 void spi_dma_xfer(uint8_t *buffer, uint8_t len);
+void spi_dma_xfer_async(uint8_t *buffer, uint8_t len);
 #define spi_csn_lo() { gpio_clear(CC2500_SPI_GPIO, CC2500_SPI_CSN_PIN); delay_us(1); }
 #define spi_csn_hi() { delay_us(1); gpio_set(CC2500_SPI_GPIO, CC2500_SPI_CSN_PIN); }
 uint8_t spi_tx(uint8_t data);
@@ -18,6 +18,9 @@
 */
 
 #include "storage.h"
+#include "adc.h"
+#include "mixer.h"
+#include "lswitch.h"
 #include "debug.h"
 #include "wdt.h"
 #include "delay.h"
@@ -124,7 +127,7 @@ static uint16_t storage_calc_crc(void) {
 }
 
 static void storage_load_defaults(void) {
-    uint8_t i;
+    uint8_t i, j;
 
     debug("storage: reading defaults\n"); debug_flush();
 
@@ -139,6 +142,9 @@ static void storage_load_defaults(void) {
 
     storage.frsky_freq_offset = FRSKY_DEFAULT_FSCAL_VALUE;
 
+    // no pll calibration cached yet
+    storage.frsky_calib_key = 0;
+
     // copy hoptable
     for (i = 0; i < FRSKY_HOPTABLE_SIZE; i++) {
         storage.frsky_hop_table[i] = tmp[i];
@@ -162,6 +168,35 @@ static void storage_load_defaults(void) {
         storage.model[i].name[6] = 0;
         storage.model[i].timer = 3*60;
         storage.model[i].stick_scale = 100;
+        storage.model[i].protocol = FRSKY_PROTOCOL_D8;
+        storage.model[i].rf_schedule = FRSKY_SCHEDULE_D8_TELEMETRY;
+        // linear sticks, no mixes
+        for (j = 0; j < STORAGE_STICK_COUNT; j++) {
+            storage.model[i].expo[j] = 0;
+            storage.model[i].rate[j][0] = 100;
+            storage.model[i].rate[j][1] = 70;
+        }
+        storage.model[i].dr_switch = STORAGE_LSWITCH_NONE;
+        for (j = 0; j < STORAGE_CURVE_POINTS; j++) {
+            storage.model[i].curve[j] = -100 + j * (200 / (STORAGE_CURVE_POINTS - 1));
+        }
+        for (j = 0; j < STORAGE_MIX_COUNT; j++) {
+            storage.model[i].mix[j].src = STORAGE_MIX_SRC_NONE;
+            storage.model[i].mix[j].dst = 0;
+            storage.model[i].mix[j].weight = 100;
+            storage.model[i].mix[j].flags = 0;
+        }
+        // switch 0: throttle above 10% of its travel, runs the timer
+        for (j = 0; j < STORAGE_LSWITCH_COUNT; j++) {
+            storage.model[i].lswitch[j].func = LSWITCH_FUNC_NONE;
+            storage.model[i].lswitch[j].a = STORAGE_LSWITCH_NONE;
+            storage.model[i].lswitch[j].b = STORAGE_LSWITCH_NONE;
+            storage.model[i].lswitch[j].value = 0;
+        }
+        storage.model[i].lswitch[0].func = LSWITCH_FUNC_GT;
+        storage.model[i].lswitch[0].a = CHANNEL_ID_THROTTLE;
+        storage.model[i].lswitch[0].value = -80;
+        storage.model[i].timer_switch = 0;
     }
 
     // add example model
@@ -203,6 +238,11 @@ void storage_mode_set_name(uint8_t index, char *str) {
 void storage_load(void) {
     debug("storage: load\n"); debug_flush();
     eeprom_read_storage();
+
+    // stick calibration and scale might have changed
+    adc_calibration_update();
+    mixer_compile();
+    lswitch_compile();
 }
 
 void storage_save(void) {
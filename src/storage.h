@@ -24,9 +24,22 @@
 
 #include "frsky.h"
 
-#define STORAGE_VERSION_ID 0x03
+#define STORAGE_VERSION_ID 0x09
 #define STORAGE_MODEL_NAME_LEN 11
 #define STORAGE_MODEL_MAX_COUNT 10
+// mixer settings per model
+#define STORAGE_STICK_COUNT   4
+#define STORAGE_MIX_COUNT     4
+#define STORAGE_CURVE_POINTS  5
+#define STORAGE_MIX_SRC_NONE  0x0F
+#define STORAGE_MIX_FLAG_CURVE (1<<0)
+// logical switches per model
+#define STORAGE_LSWITCH_COUNT 4
+#define STORAGE_LSWITCH_NONE  0x0F
+// logical switch sources (4 bit): channel ids or STORAGE_LSWITCH_SRC_SWITCH | n
+#define STORAGE_LSWITCH_SRC_SWITCH 0x08
+#define STORAGE_LSWITCH_FUNC_MASK  0x0F
+#define STORAGE_LSWITCH_FLAG_BEEP  (1<<4)
 
 void storage_init(void);
 // static void storage_init_memory(void);
@@ -38,6 +51,28 @@ void storage_mode_set_name(uint8_t index, char *str);
 /*static void storage_write(uint8_t *buffer, uint16_t len);
 static void storage_read(uint8_t *storage_ptr, uint16_t len);*/
 
+// mix line: dst += weight% * src (optionally through the model curve)
+typedef struct {
+    // channel ids (CHANNEL_ID_*), src = STORAGE_MIX_SRC_NONE disables the line
+    uint8_t src : 4;
+    uint8_t dst : 3;
+    // STORAGE_MIX_FLAG_*
+    uint8_t flags : 1;
+    // -100 ... 100 %
+    int8_t weight;
+} MIX_DESC;
+
+// logical switch, see lswitch.h for the functions
+typedef struct {
+    // LSWITCH_FUNC_* | STORAGE_LSWITCH_FLAG_*
+    uint8_t func;
+    // sources, channel id or STORAGE_LSWITCH_SRC_SWITCH | index
+    uint8_t a : 4;
+    uint8_t b : 4;
+    // threshold in percent
+    int8_t value;
+} LSWITCH_DESC;
+
 // model description
 typedef struct {
     // name of the model
@@ -46,6 +81,24 @@ typedef struct {
     uint16_t timer;
     // scale
     uint8_t stick_scale;
+    // rf protocol (FRSKY_PROTOCOL_*)
+    uint8_t protocol;
+    // rf slot schedule (FRSKY_SCHEDULE_*)
+    uint8_t rf_schedule;
+    // expo per stick in percent (0 = linear)
+    int8_t expo[STORAGE_STICK_COUNT];
+    // dual rates per stick in percent: [0] = high, [1] = low
+    uint8_t rate[STORAGE_STICK_COUNT][2];
+    // low rates are active while this logical switch is on (or STORAGE_LSWITCH_NONE)
+    uint8_t dr_switch;
+    // model curve, points at -100, -50, 0, 50, 100 %
+    int8_t curve[STORAGE_CURVE_POINTS];
+    // mix lines, added to the outputs
+    MIX_DESC mix[STORAGE_MIX_COUNT];
+    // logical switches
+    LSWITCH_DESC lswitch[STORAGE_LSWITCH_COUNT];
+    // the timer counts down while this logical switch is on
+    uint8_t timer_switch;
     // add further data here...
 } MODEL_DESC;
 
@@ -57,6 +110,13 @@ typedef struct {
     uint8_t frsky_txid[2];
     uint8_t frsky_hop_table[FRSKY_HOPTABLE_SIZE];
     int8_t  frsky_freq_offset;
+    // pll calibration cache, valid if the key matches (0 = empty)
+    uint16_t frsky_calib_key;
+    // chip temperature during the calibration in deg C
+    int8_t frsky_calib_temperature;
+    uint8_t frsky_calib_fscal1[FRSKY_HOPTABLE_SIZE];
+    uint8_t frsky_calib_fscal2;
+    uint8_t frsky_calib_fscal3;
     // stick calibration data
     uint16_t stick_calibration[4][3];
     // model settings
@@ -20,191 +20,395 @@
 #include "telemetry.h"
 #include "debug.h"
 #include "fifo.h"
+#include "rftiming.h"
+#include "seqlock.h"
 
 // telemetry fifo size, has to be a power of 2 !
 #define TELEMETRY_BUFFER_LENGTH 64
-static volatile uint8_t telemetry_buffer[TELEMETRY_BUFFER_LENGTH];
-fifo_buffer_t telemetry_fifo_buffer;
+FIFO_DECLARE(telemetry_fifo, TELEMETRY_BUFFER_LENGTH);
+
+// next state and action for every state and byte class
+static const uint8_t telemetry_fsm[TELEMETRY_DATA_END + 1][TELEMETRY_CLASS_COUNT] = {
+    // per state: data byte, 0x5e, 0x5d
+    [TELEMETRY_IDLE]      = { TELEMETRY_FSM(TELEMETRY_IDLE,      TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_IDLE,      TELEMETRY_ACTION_NONE) },
+    [TELEMETRY_DATA_ID]   = { TELEMETRY_FSM(TELEMETRY_DATA_LOW,  TELEMETRY_ACTION_ID),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_UNSTUFF) },
+    [TELEMETRY_DATA_LOW]  = { TELEMETRY_FSM(TELEMETRY_DATA_HIGH, TELEMETRY_ACTION_LOW),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_DATA_LOW,  TELEMETRY_ACTION_UNSTUFF) },
+    [TELEMETRY_DATA_HIGH] = { TELEMETRY_FSM(TELEMETRY_DATA_END,  TELEMETRY_ACTION_HIGH),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_DATA_HIGH, TELEMETRY_ACTION_UNSTUFF) },
+    // a frame ends with 0x5e, which also starts the next one
+    [TELEMETRY_DATA_END]  = { TELEMETRY_FSM(TELEMETRY_IDLE,      TELEMETRY_ACTION_NONE),
+                              TELEMETRY_FSM(TELEMETRY_DATA_ID,   TELEMETRY_ACTION_COMMIT),
+                              TELEMETRY_FSM(TELEMETRY_IDLE,      TELEMETRY_ACTION_NONE) }
+};
+
+// defined in protocol_sensor_hub.pdf, unlisted ids are ignored
+static const telemetry_hub_entry_t telemetry_hub_table[TELEMETRY_HUB_ID_COUNT] = {
+    // GPS_ALT (whole number & sign) -500m-9000m, the fraction (0x09) is
+    // ignored like opentx does
+    [0x01] = { TELEMETRY_SENSOR_GPS_ALTITUDE,  TELEMETRY_HUB_BP },
+    // TEMP1 -30C-250C (1C/ count)
+    [0x02] = { TELEMETRY_SENSOR_TEMP1,         TELEMETRY_HUB_INT },
+    // RPM   0-60000
+    [0x03] = { TELEMETRY_SENSOR_RPM,           TELEMETRY_HUB_UINT },
+    // Fuel 0, 25, 50, 75, 100, betaflight sends the capacity in mah
+    [0x04] = { TELEMETRY_SENSOR_FUEL,          TELEMETRY_HUB_UINT },
+    // TEMP2 -30C-250C (1C/ count)
+    [0x05] = { TELEMETRY_SENSOR_TEMP2,         TELEMETRY_HUB_INT },
+    // Battery voltages - CELL# and VOLT
+    [0x06] = { TELEMETRY_SENSOR_CELL_MIN,      TELEMETRY_HUB_CELL },
+    // ALT (whole number & sign) -500m-9000m (.01m/count)
+    [0x10] = { TELEMETRY_SENSOR_ALTITUDE,      TELEMETRY_HUB_BP },
+    [0x21] = { TELEMETRY_SENSOR_ALTITUDE,      TELEMETRY_HUB_AP },
+    // GPS Speed in Knots
+    [0x11] = { TELEMETRY_SENSOR_GPS_SPEED,     TELEMETRY_HUB_BP },
+    [0x19] = { TELEMETRY_SENSOR_GPS_SPEED,     TELEMETRY_HUB_AP },
+    // GPS Longitude dddmm.mmmm and E/W
+    [0x12] = { TELEMETRY_SENSOR_GPS_LONGITUDE, TELEMETRY_HUB_GPS_BP },
+    [0x1A] = { TELEMETRY_SENSOR_GPS_LONGITUDE, TELEMETRY_HUB_GPS_AP },
+    [0x22] = { TELEMETRY_SENSOR_GPS_LONGITUDE, TELEMETRY_HUB_HEMISPHERE },
+    // GPS Latitude ddmm.mmmm and N/S
+    [0x13] = { TELEMETRY_SENSOR_GPS_LATITUDE,  TELEMETRY_HUB_GPS_BP },
+    [0x1B] = { TELEMETRY_SENSOR_GPS_LATITUDE,  TELEMETRY_HUB_GPS_AP },
+    [0x23] = { TELEMETRY_SENSOR_GPS_LATITUDE,  TELEMETRY_HUB_HEMISPHERE },
+    // GPS Compass (0-259.99) (.01degree/count)
+    [0x14] = { TELEMETRY_SENSOR_GPS_COURSE,    TELEMETRY_HUB_BP },
+    [0x1C] = { TELEMETRY_SENSOR_GPS_COURSE,    TELEMETRY_HUB_AP },
+    // GPS Date/Month and Year
+    [0x15] = { TELEMETRY_SENSOR_GPS_DATE,      TELEMETRY_HUB_HOLD },
+    [0x16] = { TELEMETRY_SENSOR_GPS_DATE,      TELEMETRY_HUB_DATE },
+    // GPS Hour/Minute and Second
+    [0x17] = { TELEMETRY_SENSOR_GPS_TIME,      TELEMETRY_HUB_HOLD },
+    [0x18] = { TELEMETRY_SENSOR_GPS_TIME,      TELEMETRY_HUB_TIME },
+    // Accel X/Y/Z (1/1000 g)
+    [0x24] = { TELEMETRY_SENSOR_ACCEL_X,       TELEMETRY_HUB_INT },
+    [0x25] = { TELEMETRY_SENSOR_ACCEL_Y,       TELEMETRY_HUB_INT },
+    [0x26] = { TELEMETRY_SENSOR_ACCEL_Z,       TELEMETRY_HUB_INT },
+    // Current 0A-100A (0.1A/count)
+    [0x28] = { TELEMETRY_SENSOR_CURRENT,       TELEMETRY_HUB_X10 },
+    // VARIO (.01m/s)
+    [0x30] = { TELEMETRY_SENSOR_VARIO,         TELEMETRY_HUB_INT },
+    // VFAS_ID (0.1V/count)
+    [0x39] = { TELEMETRY_SENSOR_VOLTAGE,       TELEMETRY_HUB_X10 },
+    // Ampere sensor voltage, whole number and fractional part
+    [0x3A] = { TELEMETRY_SENSOR_VOLTAGE,       TELEMETRY_HUB_HOLD },
+    [0x3B] = { TELEMETRY_SENSOR_VOLTAGE,       TELEMETRY_HUB_AMP_VOLT }
+};
 
 static telemetry_state_t telemetry_state;
 static uint8_t telemetry_data_id;
 static uint8_t telemetry_high_byte;
 static uint8_t telemetry_low_byte;
-static uint16_t telemetry_last_value;
-static uint8_t  telemetry_last_id;
 
-static uint16_t telemetry_decoded_data_voltage;
-static uint16_t telemetry_decoded_data_current;
-static uint16_t telemetry_decoded_data_mah;
+static telemetry_sensor_t telemetry_sensor[TELEMETRY_SENSOR_COUNT];
+// whole parts waiting for their fraction
+static int16_t telemetry_hub_whole[TELEMETRY_SENSOR_COUNT];
+// sensors on the southern/western hemisphere
+static uint32_t telemetry_hub_negative;
+static uint16_t telemetry_cell[TELEMETRY_CELL_MAX];
+static uint8_t telemetry_cell_count;
+// next sensor to check for staleness
+static uint8_t telemetry_stale_index;
+
+// link data from the d8 frame, written by the rf bottom half
+static volatile uint8_t telemetry_link_a1;
+static volatile uint8_t telemetry_link_a2;
+static volatile uint8_t telemetry_link_rssi;
+static seqlock_t telemetry_link_seqlock;
+static uint32_t telemetry_link_processed;
 
 // internal functions
 static void telemetry_parse_stream(uint8_t byte);
 static void telemetry_process_hub_packet(uint8_t id, uint16_t value);
+static void telemetry_process_link(void);
+static void telemetry_process_cell(uint16_t value);
+static void telemetry_sensor_update(uint8_t id, int32_t value);
+static void telemetry_check_stale(void);
 
 void telemetry_init(void) {
+    uint32_t i;
+
     debug("telemetry: init\n"); debug_flush();
 
     telemetry_state = TELEMETRY_IDLE;
-    telemetry_decoded_data_voltage = 0;
-    telemetry_decoded_data_current = 0;
-    telemetry_last_value = 0;
     telemetry_data_id = 0;
-    telemetry_last_id = 0;
     telemetry_high_byte = 0;
     telemetry_low_byte = 0;
 
-    // init isr safe fifo
-    fifo_init(&telemetry_fifo_buffer, telemetry_buffer, TELEMETRY_BUFFER_LENGTH);
+    for (i = 0; i < TELEMETRY_SENSOR_COUNT; i++) {
+        telemetry_sensor[i].value = 0;
+        telemetry_sensor[i].timestamp = 0;
+        telemetry_sensor[i].flags = 0;
+        telemetry_hub_whole[i] = 0;
+    }
+    telemetry_hub_negative = 0;
+    telemetry_cell_count = 0;
+    telemetry_stale_index = 0;
+
+    seqlock_init(&telemetry_link_seqlock);
+    telemetry_link_processed = 0;
+
+    // start with an empty isr safe fifo
+    fifo_flush(&telemetry_fifo);
 }
 
-void telemetry_enqueue(uint8_t byte) {
-    // debug("telemetry: enq 0x"); debug_put_hex8(byte); debug_put_newline(); debug_flush();
-    // insert into fifo
-    if (!fifo_put(&telemetry_fifo_buffer, byte)) {
+void telemetry_enqueue(const uint8_t *data, uint8_t len) {
+    // insert into fifo, a chunk that does not fit is dropped as a whole.
+    // the parser resyncs on the next frame start
+    if (!fifo_put_multi(&telemetry_fifo, data, len)) {
         // debug("telemetry: fifo full\n");
     }
 }
 
+// called by the rf bottom half for every valid telemetry frame
+void telemetry_set_link(uint8_t a1, uint8_t a2, uint8_t rssi) {
+    seqlock_write_begin(&telemetry_link_seqlock);
+    telemetry_link_a1 = a1;
+    telemetry_link_a2 = a2;
+    telemetry_link_rssi = rssi;
+    seqlock_write_end(&telemetry_link_seqlock);
+}
+
 void telemetry_process(void) {
-    // handle telemetry packets
-    if (!fifo_empty(&telemetry_fifo_buffer)) {
-        uint8_t byte = fifo_get(&telemetry_fifo_buffer);
-        // process incoming telemetry
-        telemetry_parse_stream(byte);
+    uint8_t buffer[TELEMETRY_PROCESS_CHUNK];
+    uint32_t count, i;
+
+    telemetry_process_link();
+
+    // handle all telemetry bytes received so far
+    count = fifo_get_multi(&telemetry_fifo, buffer, sizeof(buffer));
+    while (count) {
+        for (i = 0; i < count; i++) {
+            // process incoming telemetry
+            telemetry_parse_stream(buffer[i]);
+        }
+        count = fifo_get_multi(&telemetry_fifo, buffer, sizeof(buffer));
     }
+
+    telemetry_check_stale();
 }
 
-static void telemetry_parse_stream(uint8_t byte) {
-    if (telemetry_state == TELEMETRY_DATA_END) {
-        if (byte == 0x5e) {
-            telemetry_process_hub_packet(telemetry_data_id,
-                                         (telemetry_high_byte << 8) + telemetry_low_byte);
-            telemetry_state = TELEMETRY_DATA_ID;
-        } else {
-            telemetry_state = TELEMETRY_IDLE;
-        }
+static void telemetry_process_link(void) {
+    uint32_t sequence;
+    uint8_t a1, a2, rssi;
+
+    do {
+        sequence = seqlock_read_begin(&telemetry_link_seqlock);
+        a1 = telemetry_link_a1;
+        a2 = telemetry_link_a2;
+        rssi = telemetry_link_rssi;
+    } while (seqlock_read_retry(&telemetry_link_seqlock, sequence));
+
+    if (sequence == telemetry_link_processed) {
+        // nothing new
         return;
     }
-    if (byte == 0x5e) {
-        telemetry_state = TELEMETRY_DATA_ID;
-        return;
+    telemetry_link_processed = sequence;
+
+    telemetry_sensor_update(TELEMETRY_SENSOR_A1, a1);
+    telemetry_sensor_update(TELEMETRY_SENSOR_A2, a2);
+    telemetry_sensor_update(TELEMETRY_SENSOR_RSSI, rssi);
+}
+
+// one sensor per call, telemetry_process() is called continuously
+static void telemetry_check_stale(void) {
+    telemetry_sensor_t *sensor = &telemetry_sensor[telemetry_stale_index];
+
+    if ((sensor->flags & TELEMETRY_SENSOR_FLAG_VALID) &&
+        ((uint32_t)(rftiming_now() - sensor->timestamp) > TELEMETRY_SENSOR_STALE_US)) {
+        sensor->flags |= TELEMETRY_SENSOR_FLAG_STALE;
     }
-    if (telemetry_state == TELEMETRY_IDLE) {
-        return;
+
+    telemetry_stale_index++;
+    if (telemetry_stale_index >= TELEMETRY_SENSOR_COUNT) {
+        telemetry_stale_index = 0;
     }
-    if (telemetry_state & TELEMETRY_XOR) {
+}
+
+static void telemetry_sensor_update(uint8_t id, int32_t value) {
+    telemetry_sensor[id].value = value;
+    telemetry_sensor[id].timestamp = rftiming_now();
+    telemetry_sensor[id].flags = TELEMETRY_SENSOR_FLAG_VALID;
+}
+
+static void telemetry_parse_stream(uint8_t byte) {
+    uint8_t byte_class = TELEMETRY_CLASS_DATA;
+    uint8_t entry;
+
+    if (byte == 0x5e) {
+        byte_class = TELEMETRY_CLASS_START;
+    } else if (telemetry_state & TELEMETRY_XOR) {
         byte = byte ^ 0x60;
-        telemetry_state = (telemetry_state_t)(telemetry_state - TELEMETRY_XOR);
     } else if (byte == 0x5d) {
-        telemetry_state = (telemetry_state_t)(telemetry_state | TELEMETRY_XOR);
-        return;
-    }
-    if (telemetry_state == TELEMETRY_DATA_ID) {
-        if (byte > 0x3f) {
-            telemetry_state = TELEMETRY_IDLE;
-        } else {
-            telemetry_data_id = byte;
-            telemetry_state = TELEMETRY_DATA_LOW;
-        }
-        return;
-    }
-    if (telemetry_state == TELEMETRY_DATA_LOW) {
-        telemetry_low_byte = byte;
-        telemetry_state = TELEMETRY_DATA_HIGH;
-        return;
+        byte_class = TELEMETRY_CLASS_STUFF;
     }
-    if (telemetry_state == TELEMETRY_DATA_HIGH) {
-        telemetry_high_byte = byte;
-        telemetry_state = TELEMETRY_DATA_END;
+    telemetry_state = (telemetry_state_t)(telemetry_state & ~TELEMETRY_XOR);
+
+    entry = telemetry_fsm[telemetry_state][byte_class];
+    telemetry_state = (telemetry_state_t)(entry >> 4);
+
+    switch (entry & 0x0F) {
+        default:
+        case (TELEMETRY_ACTION_NONE):
+            break;
+
+        case (TELEMETRY_ACTION_ID):
+            if (byte >= TELEMETRY_HUB_ID_COUNT) {
+                telemetry_state = TELEMETRY_IDLE;
+            } else {
+                telemetry_data_id = byte;
+            }
+            break;
+
+        case (TELEMETRY_ACTION_LOW):
+            telemetry_low_byte = byte;
+            break;
+
+        case (TELEMETRY_ACTION_HIGH):
+            telemetry_high_byte = byte;
+            break;
+
+        case (TELEMETRY_ACTION_COMMIT):
+            telemetry_process_hub_packet(telemetry_data_id,
+                                         (telemetry_high_byte << 8) + telemetry_low_byte);
+            break;
+
+        case (TELEMETRY_ACTION_UNSTUFF):
+            telemetry_state = (telemetry_state_t)(telemetry_state | TELEMETRY_XOR);
+            break;
     }
 }
 
 static void telemetry_process_hub_packet(uint8_t id, uint16_t value) {
-    // process hub data
-    switch (id) {
-        // defined in protocol_sensor_hub.pdf
+    const telemetry_hub_entry_t *entry = &telemetry_hub_table[id];
+    uint8_t sensor = entry->sensor;
+    int32_t whole = telemetry_hub_whole[sensor];
+    uint16_t held = (uint16_t)telemetry_hub_whole[sensor];
+    int32_t result;
+
+    switch (entry->decode) {
         default:
-        case 0x01:  // GPS_ALT (whole number & sign) -500m-9000m (.01m/count)
-        case 0x09:  // GPS_ALT (fraction)  TODO opentx throws away the ap value and only uses bp
-        case 0x02:  // TEMP1 -30C-250C (1C/ count)
-        case 0x03:  // RPM   0-60000
-        case 0x05:  // TEMP2 -30C-250C (1C/ count)
-        case 0x06:  // Battery voltages - CELL# and VOLT
-        case 0x10:  // ALT (whole number & sign) -500m-9000m (.01m/count)
-        case 0x21:  // ALT (fraction)  (.01m/count)
-        case 0x11:  // GPS Speed (whole number and sign) in Knots
-        case 0x19:  // GPS Speed (fraction)
-        case 0x12:  // GPS Longitude (whole number) dddmm.mmmm
-        case 0x1A:  // GPS Longitude (fraction)
-        case 0x22:  // GPS Longitude E/W
-        case 0x13:  // GPS Latitude (whole number) ddmm.mmmm
-        case 0x1B:  // GPS Latitude (fraction)
-        case 0x23:  // GPS Latitude N/S
-        case 0x14:  // GPS Compass (whole number) (0-259.99) (.01degree/count)
-        case 0x1C:  // GPS Compass (fraction)
-        case 0x15:  // GPS Date/Month
-        case 0x16:  // GPS Year
-        case 0x17:  // GPS Hour/Minute
-        case 0x18:  // GPS Second
-        case 0x24:  // Accel X
-        case 0x25:  // Accel Y
-        case 0x26:  // Accel Z
-        case 0x30:  // VARIO
-            // we will ignore this data
-            break;
-
-        case 0x04:  // Fuel  0, 25, 50, 75, 100
-            // betaflight sends capacity in mah (default)
-            telemetry_decoded_data_mah =  value;
-            break;
-
-
-        case 0x28:  // Current 0A-100A (0.1A/count)
-            telemetry_decoded_data_current = value * 10;
-            /*set_telemetry(TELEM_FRSKY_CURRENT, value);
-            if (discharge_time == 0) discharge_time = CLOCK_getms();
-            discharge_dAms += (u32)value * (CLOCK_getms() - discharge_time);
-            discharge_time = CLOCK_getms();
-            set_telemetry(TELEM_FRSKY_DISCHARGE, discharge_dAms / 36000);*/
-            break;
-
-        case 0x39:  // VFAS_ID
-            telemetry_decoded_data_voltage = value * 10;
-            break;
-
-        case 0x3A:  // Ampere sensor voltage (whole number) (measured as V) 0V-48V (0.5V/count)
-            telemetry_last_id    = id;
-            telemetry_last_value = value;
-            break;
-        case 0x3B:  // Ampere sensor voltage (fractional part)
-            if (telemetry_last_id == 0x3A) {
-                telemetry_decoded_data_voltage =
-                        ((telemetry_last_value * 100 + value * 10) * 210) / 110;
+        case (TELEMETRY_HUB_NONE):
+            return;
+
+        case (TELEMETRY_HUB_INT):
+            result = (int16_t)value;
+            break;
+
+        case (TELEMETRY_HUB_UINT):
+            result = value;
+            break;
+
+        case (TELEMETRY_HUB_X10):
+            result = value * 10;
+            break;
+
+        case (TELEMETRY_HUB_HOLD):
+            telemetry_hub_whole[sensor] = value;
+            return;
+
+        case (TELEMETRY_HUB_BP):
+            // publish the whole part, some sensors never send a fraction
+            telemetry_hub_whole[sensor] = value;
+            result = (int16_t)value * 100;
+            break;
+
+        case (TELEMETRY_HUB_AP):
+            result = (whole < 0) ? (whole * 100 - value) : (whole * 100 + value);
+            break;
+
+        case (TELEMETRY_HUB_GPS_BP):
+            telemetry_hub_whole[sensor] = value;
+            result = (uint16_t)value * 10000;
+            if (telemetry_hub_negative & (1 << sensor)) {
+                result = -result;
             }
             break;
-    }
-/*
-    if (value >= VFAS_D_HIPREC_OFFSET) {
-        // incoming value has a resolution of 0.01V and added offset of VFAS_D_HIPREC_OFFSET
-        value -= VFAS_D_HIPREC_OFFSET;
-    } else {
-        // incoming value has a resolution of 0.1V
-        value *= 10;
-    }
-    set_telemetry(TELEM_FRSKY_VOLT3, value);
+
+        case (TELEMETRY_HUB_GPS_AP):
+            result = held * 10000 + value;
+            if (telemetry_hub_negative & (1 << sensor)) {
+                result = -result;
+            }
             break;
-*/
+
+        case (TELEMETRY_HUB_HEMISPHERE):
+            if (((value & 0xFF) == 'S') || ((value & 0xFF) == 'W')) {
+                telemetry_hub_negative |= (1 << sensor);
+            } else {
+                telemetry_hub_negative &= ~(1 << sensor);
+            }
+            return;
+
+        case (TELEMETRY_HUB_AMP_VOLT):
+            // measured as V, 0V-48V (0.5V/count), 210/110 divider
+            result = ((whole * 100 + value * 10) * 210) / 110;
+            break;
+
+        case (TELEMETRY_HUB_CELL):
+            telemetry_process_cell(value);
+            return;
+
+        case (TELEMETRY_HUB_DATE):
+            // day in the low, month in the high byte
+            result = (value % 100) * 10000 + (held >> 8) * 100 + (held & 0xFF);
+            break;
+
+        case (TELEMETRY_HUB_TIME):
+            // hour in the low, minute in the high byte
+            result = (held & 0xFF) * 3600 + (held >> 8) * 60 + (value & 0xFF);
+            break;
+    }
+
+    telemetry_sensor_update(sensor, result);
 }
 
+static void telemetry_process_cell(uint16_t value) {
+    // cell number in bits 4..7, voltage in 2mV steps, high nibble first
+    uint8_t cell = (value >> 4) & 0x0F;
+    uint32_t i, sum, lowest;
+
+    if (cell >= TELEMETRY_CELL_MAX) {
+        return;
+    }
+
+    telemetry_cell[cell] = (((value & 0x0F) << 8) + (value >> 8)) / 5;
+    if (cell >= telemetry_cell_count) {
+        // unknown cells read as 0 until they are received
+        for (i = telemetry_cell_count; i < cell; i++) {
+            telemetry_cell[i] = 0;
+        }
+        telemetry_cell_count = cell + 1;
+    }
+
+    sum = 0;
+    lowest = 0xFFFF;
+    for (i = 0; i < telemetry_cell_count; i++) {
+        sum += telemetry_cell[i];
+        if ((telemetry_cell[i] != 0) && (telemetry_cell[i] < lowest)) {
+            lowest = telemetry_cell[i];
+        }
+    }
+
+    telemetry_sensor_update(TELEMETRY_SENSOR_CELL_MIN, lowest);
+    telemetry_sensor_update(TELEMETRY_SENSOR_CELL_SUM, sum);
+}
 
-uint16_t telemetry_get_voltage(void) {
-    return telemetry_decoded_data_voltage;
+const telemetry_sensor_t *telemetry_get_sensor(telemetry_sensor_id_t id) {
+    return &telemetry_sensor[id];
 }
 
-uint16_t telemetry_get_current(void) {
-    return telemetry_decoded_data_current;
+// last value, also if stale. 0 if never received
+int32_t telemetry_get_value(telemetry_sensor_id_t id) {
+    return telemetry_sensor[id].value;
 }
 
-uint16_t telemetry_get_mah(void) {
-    return telemetry_decoded_data_mah;
+uint32_t telemetry_sensor_fresh(telemetry_sensor_id_t id) {
+    return (telemetry_sensor[id].flags == TELEMETRY_SENSOR_FLAG_VALID);
 }
@@ -23,13 +23,86 @@
 #include <stdint.h>
 #include "fifo.h"
 
+// bytes taken from the fifo per access
+#define TELEMETRY_PROCESS_CHUNK 16
+
+// sensor table, units are noted per sensor
+typedef enum {
+  // d8 telemetry frame
+  TELEMETRY_SENSOR_A1 = 0,         // raw 0..255
+  TELEMETRY_SENSOR_A2,             // raw 0..255
+  TELEMETRY_SENSOR_RSSI,           // rssi of our signal at the receiver
+  // hub
+  TELEMETRY_SENSOR_VOLTAGE,        // 0.01V
+  TELEMETRY_SENSOR_CURRENT,        // 0.01A
+  TELEMETRY_SENSOR_FUEL,           // betaflight sends the used capacity in mAh
+  TELEMETRY_SENSOR_TEMP1,          // 1C
+  TELEMETRY_SENSOR_TEMP2,          // 1C
+  TELEMETRY_SENSOR_RPM,            // as sent by the hub
+  TELEMETRY_SENSOR_ALTITUDE,       // 0.01m
+  TELEMETRY_SENSOR_VARIO,          // 0.01m/s
+  TELEMETRY_SENSOR_CELL_MIN,       // 0.01V, lowest cell
+  TELEMETRY_SENSOR_CELL_SUM,       // 0.01V, all cells
+  TELEMETRY_SENSOR_GPS_ALTITUDE,   // 0.01m, whole meters only
+  TELEMETRY_SENSOR_GPS_SPEED,      // 0.01 knots
+  TELEMETRY_SENSOR_GPS_LATITUDE,   // ddmm.mmmm * 10000, south is negative
+  TELEMETRY_SENSOR_GPS_LONGITUDE,  // dddmm.mmmm * 10000, west is negative
+  TELEMETRY_SENSOR_GPS_COURSE,     // 0.01 degree
+  TELEMETRY_SENSOR_GPS_DATE,       // yymmdd
+  TELEMETRY_SENSOR_GPS_TIME,       // seconds of the day
+  TELEMETRY_SENSOR_ACCEL_X,        // 0.001g
+  TELEMETRY_SENSOR_ACCEL_Y,        // 0.001g
+  TELEMETRY_SENSOR_ACCEL_Z,        // 0.001g
+  TELEMETRY_SENSOR_COUNT
+} telemetry_sensor_id_t;
+
+// received at least once
+#define TELEMETRY_SENSOR_FLAG_VALID 0x01
+// no update within TELEMETRY_SENSOR_STALE_US
+#define TELEMETRY_SENSOR_FLAG_STALE 0x02
+#define TELEMETRY_SENSOR_STALE_US   3000000
+
+typedef struct {
+    int32_t value;
+    // rftiming_now() of the last update
+    uint32_t timestamp;
+    uint8_t flags;
+} telemetry_sensor_t;
+
+// hub data id to sensor mapping, ids are 0x00..0x3f
+#define TELEMETRY_HUB_ID_COUNT 0x40
+// decoding of the hub value
+#define TELEMETRY_HUB_NONE       0   // ignored
+#define TELEMETRY_HUB_INT        1   // signed as is
+#define TELEMETRY_HUB_UINT       2   // unsigned as is
+#define TELEMETRY_HUB_X10        3   // 0.1 units to 0.01 units
+#define TELEMETRY_HUB_HOLD       4   // whole part, kept until the fraction arrives
+#define TELEMETRY_HUB_BP         5   // whole part, * 100
+#define TELEMETRY_HUB_AP         6   // fraction, whole * 100 + fraction
+#define TELEMETRY_HUB_GPS_BP     7   // whole part, * 10000
+#define TELEMETRY_HUB_GPS_AP     8   // fraction, whole * 10000 + fraction
+#define TELEMETRY_HUB_HEMISPHERE 9   // 'N'/'E' positive, 'S'/'W' negative
+#define TELEMETRY_HUB_AMP_VOLT   10  // ampere sensor voltage fraction
+#define TELEMETRY_HUB_CELL       11  // cell number and voltage
+#define TELEMETRY_HUB_DATE       12  // year, day/month is held
+#define TELEMETRY_HUB_TIME       13  // seconds, hour/minute is held
+
+typedef struct {
+    uint8_t sensor;
+    uint8_t decode;
+} telemetry_hub_entry_t;
+
+// cells reported by a FLVS sensor
+#define TELEMETRY_CELL_MAX 6
+
 void telemetry_init(void);
-void telemetry_enqueue(uint8_t byte);
+void telemetry_enqueue(const uint8_t *data, uint8_t len);
+void telemetry_set_link(uint8_t a1, uint8_t a2, uint8_t rssi);
 void telemetry_process(void);
 
-uint16_t telemetry_get_voltage(void);
-uint16_t telemetry_get_current(void);
-uint16_t telemetry_get_mah(void);
+const telemetry_sensor_t *telemetry_get_sensor(telemetry_sensor_id_t id);
+int32_t telemetry_get_value(telemetry_sensor_id_t id);
+uint32_t telemetry_sensor_fresh(telemetry_sensor_id_t id);
 
 // FrSky telemetry stream state machine
 typedef enum {
@@ -41,5 +114,19 @@ typedef enum {
   TELEMETRY_XOR = 0x80  // decode stuffed byte
 } telemetry_state_t;
 
+// byte classes and actions of the stream state machine
+#define TELEMETRY_CLASS_DATA  0
+#define TELEMETRY_CLASS_START 1  // 0x5e
+#define TELEMETRY_CLASS_STUFF 2  // 0x5d
+#define TELEMETRY_CLASS_COUNT 3
+
+#define TELEMETRY_ACTION_NONE    0
+#define TELEMETRY_ACTION_ID      1
+#define TELEMETRY_ACTION_LOW     2
+#define TELEMETRY_ACTION_HIGH    3
+#define TELEMETRY_ACTION_COMMIT  4
+#define TELEMETRY_ACTION_UNSTUFF 5
+#define TELEMETRY_FSM(_next, _action) (((_next) << 4) | (_action))
+
 
 #endif  // TELEMETRY_H_
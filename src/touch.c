@@ -23,6 +23,7 @@
 #include "timeout.h"
 #include "lcd.h"
 #include "io.h"
+#include "fifo.h"
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/exti.h>
@@ -49,12 +50,14 @@ static void touch_ft6236_init(void);
 #define TOUCH_I2C_TIMEOUT      20
 #define TOUCH_I2C_FLAG_TIMEOUT 10
 
-static volatile touch_event_t touch_event;
+// pending touch events, power of 2 bytes (10 events)
+#define TOUCH_EVENT_FIFO_LENGTH 64
+FIFO_DECLARE(touch_fifo, TOUCH_EVENT_FIFO_LENGTH);
 
 void touch_init(void) {
     debug("touch: init\n"); debug_flush();
 
-    touch_event.event_id = 0;
+    fifo_flush(&touch_fifo);
 
     touch_deinit_i2c();
     touch_init_i2c_rcc();
@@ -129,9 +132,12 @@ void EXTI4_15_IRQHandler(void) {
         exti_reset_request(TOUCH_INT_EXTI_SOURCE_LINE);
 
         // interrupt(falling edge) on Touch INT line, event detected!
-        if (touch_event.event_id == 0) {
-            // last event has been processed
+        if (fifo_space(&touch_fifo) >= sizeof(touch_event_t)) {
+            // there is room for another event
             touch_ft6236_packet_t buf;
+            touch_event_t touch_event;
+
+            touch_event.event_id = 0;
 
             // fetch data:
             uint32_t res = touch_i2c_read(0x00, (uint8_t *)&buf, sizeof(buf));
@@ -180,14 +186,26 @@ void EXTI4_15_IRQHandler(void) {
                     }
                 }
             }
+
+            // contact updates are not queued, the gui only needs
+            // gestures and the down/up positions
+            if ((touch_event.event_id != 0) &&
+                (touch_event.event_id != TOUCH_GESTURE_MOUSE_MOVE) &&
+                (touch_event.event_id != TOUCH_GESTURE_MOUSE_NONE)) {
+                fifo_put_multi(&touch_fifo, (const uint8_t *)&touch_event, sizeof(touch_event_t));
+            }
         }
     }
 }
 
 
+// returns the oldest pending event, event_id = 0 if there is none
 touch_event_t touch_get_last_event(void) {
-    touch_event_t tmp = touch_event;
-    touch_event.event_id = 0;
+    touch_event_t tmp;
+
+    if (fifo_get_multi(&touch_fifo, (uint8_t *)&tmp, sizeof(touch_event_t)) != sizeof(touch_event_t)) {
+        tmp.event_id = 0;
+    }
     return tmp;
 }
 